@@ -0,0 +1,13 @@
+# AudioMixer 混音内核基准：标量 / SSE2 / AVX2，1~10 路
+TEMPLATE = app
+TARGET = audioMixerBench
+CONFIG += console c++17
+CONFIG -= app_bundle
+QT =
+
+SOURCES += \
+    $$PWD/main.cpp \
+    $$PWD/../../s_function/play/AudioMixer.cpp
+
+HEADERS += \
+    $$PWD/../../s_function/play/AudioMixer.h
@@ -0,0 +1,98 @@
+#include "../../s_function/play/AudioMixer.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#define BENCH_SAMPLE_RATE 48000 // 采样率
+#define BENCH_CHANNELS 2 // 声道数
+#define BENCH_BLOCK_MS 20 // 单次混音的时长
+#define BENCH_MAX_STREAMS 10 // 最多同时混音的路数
+#define BENCH_ITERATIONS 2000 // 每轮计时混音的块数
+#define BENCH_ROUNDS 5 // 计时轮数，取最快的一轮，减少调度干扰
+
+namespace {
+
+const int kSamples = BENCH_SAMPLE_RATE * BENCH_CHANNELS * BENCH_BLOCK_MS / 1000;
+
+// 混音一块：各路按不同的增益渐变累加，再打包
+void mixBlock(const std::vector<std::vector<int16_t>> &streams, int streamCount,
+              std::vector<float> &acc, std::vector<int16_t> &output)
+{
+    AudioMixer::clear(acc.data(), kSamples);
+    for (int i = 0; i < streamCount; ++i) {
+        float gainStart = 0.5f + 0.05f * i;
+        AudioMixer::accumulate(acc.data(), streams[i].data(), kSamples, gainStart, gainStart * 0.9f);
+    }
+    AudioMixer::pack(output.data(), acc.data(), kSamples);
+}
+
+// 每块耗时（纳秒），取 BENCH_ROUNDS 轮中最快的一轮
+double measure(const std::vector<std::vector<int16_t>> &streams, int streamCount)
+{
+    std::vector<float> acc(kSamples);
+    std::vector<int16_t> output(kSamples);
+    mixBlock(streams, streamCount, acc, output);
+    double best = 0.0;
+    for (int round = 0; round < BENCH_ROUNDS; ++round) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < BENCH_ITERATIONS; ++i) {
+            mixBlock(streams, streamCount, acc, output);
+        }
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        double ns = std::chrono::duration<double, std::nano>(elapsed).count() / BENCH_ITERATIONS;
+        if (round == 0 || ns < best) {
+            best = ns;
+        }
+    }
+    // 防止编译器认为结果没有被使用
+    if (output[0] == 12345 && output[1] == -12345) {
+        printf(" ");
+    }
+    return best;
+}
+
+} // namespace
+
+int main()
+{
+    // 随机数据保证累加结果会超出 int16 范围，覆盖饱和打包
+    std::mt19937 rng(20240501);
+    std::uniform_int_distribution<int> dist(-32768, 32767);
+    std::vector<std::vector<int16_t>> streams(BENCH_MAX_STREAMS, std::vector<int16_t>(kSamples));
+    for (std::vector<int16_t> &stream : streams) {
+        for (int16_t &sample : stream) {
+            sample = static_cast<int16_t>(dist(rng));
+        }
+    }
+
+    // 以标量内核的结果为基准，检查各 SIMD 内核的输出
+    std::vector<float> acc(kSamples);
+    std::vector<int16_t> reference(kSamples);
+    std::vector<int16_t> output(kSamples);
+    AudioMixer::setKernel("scalar");
+    mixBlock(streams, BENCH_MAX_STREAMS, acc, reference);
+
+    printf("block: %d ms, %d Hz, %d ch (%d samples)\n", BENCH_BLOCK_MS, BENCH_SAMPLE_RATE, BENCH_CHANNELS, kSamples);
+    printf("%-8s %-8s %12s %12s\n", "kernel", "streams", "us/block", "core load");
+    const char *kernelNames[] = {"scalar", "sse2", "avx2"};
+    for (const char *name : kernelNames) {
+        if (!AudioMixer::setKernel(name)) {
+            printf("%-8s not supported\n", name);
+            continue;
+        }
+        mixBlock(streams, BENCH_MAX_STREAMS, acc, output);
+        int maxDiff = 0;
+        for (int i = 0; i < kSamples; ++i) {
+            maxDiff = std::max(maxDiff, std::abs(output[i] - reference[i]));
+        }
+        for (int streamCount = 1; streamCount <= BENCH_MAX_STREAMS; ++streamCount) {
+            double ns = measure(streams, streamCount);
+            // 占用率：混音一块的耗时 / 这块音频的播放时长
+            printf("%-8s %-8d %12.2f %11.4f%%\n", name, streamCount, ns / 1000.0, ns / (BENCH_BLOCK_MS * 1e6) * 100.0);
+        }
+        printf("%-8s max diff vs scalar: %d LSB\n", name, maxDiff);
+    }
+    return 0;
+}
@@ -0,0 +1,9 @@
+# 性能基准测试，与主程序分开构建：
+#   qmake bench/bench.pro && make
+# 各基准程序直接编译被测的源文件，输出结果到标准输出
+TEMPLATE = subdirs
+
+SUBDIRS += \
+    audioMixer \
+    decodeThreads \
+    yuvConverter
@@ -0,0 +1,16 @@
+# 视频解码多线程基准：按线程数和多线程方式统计解码速度
+#   decodeThreadsBench <媒体文件> [最多解码帧数]
+TEMPLATE = app
+TARGET = decodeThreadsBench
+CONFIG += console c++17
+CONFIG -= app_bundle
+QT =
+
+SOURCES += \
+    $$PWD/main.cpp
+
+# FFmpeg 库配置，与主程序相同
+INCLUDEPATH += $$PWD/../../thirdParty/ffmpeg/include
+FFMPEG_LIB_DIR = $$PWD/../../thirdParty/ffmpeg/lib
+LIBS += -L$$FFMPEG_LIB_DIR/ -lavcodec -lavformat -lavutil
+QMAKE_RPATHDIR += $$shell_path($$FFMPEG_LIB_DIR)
@@ -0,0 +1,136 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+}
+
+#define BENCH_DEFAULT_FRAMES 600 // 默认每种配置最多解码的帧数
+
+namespace {
+
+struct Result {
+    int frames;
+    double seconds;
+    int delayFrames;    // 第一帧输出之前送入的数据包数，即多线程带来的输出延迟
+    int threadCount;    // 解码器实际使用的线程数
+    int threadType;     // 解码器实际使用的多线程方式
+};
+
+// 从头解码最多 maxFrames 帧，只统计 send/receive 的耗时，与 VideoCode::getDecodeFps() 的口径一致
+bool decode(AVFormatContext *formatContext, int streamIndex, int threadCount, int threadType,
+            int maxFrames, Result &result)
+{
+    AVStream *stream = formatContext->streams[streamIndex];
+    const AVCodec *codec = avcodec_find_decoder(stream->codecpar->codec_id);
+    AVCodecContext *context = codec ? avcodec_alloc_context3(codec) : nullptr;
+    if (!context || avcodec_parameters_to_context(context, stream->codecpar) < 0) {
+        avcodec_free_context(&context);
+        return false;
+    }
+    context->thread_count = threadCount;
+    context->thread_type = threadType;
+    if (avcodec_open2(context, codec, nullptr) < 0) {
+        avcodec_free_context(&context);
+        return false;
+    }
+    result = Result{0, 0.0, -1, context->thread_count, context->active_thread_type};
+
+    av_seek_frame(formatContext, streamIndex, stream->start_time != AV_NOPTS_VALUE ? stream->start_time : 0,
+                  AVSEEK_FLAG_BACKWARD);
+    AVPacket *packet = av_packet_alloc();
+    AVFrame *frame = av_frame_alloc();
+    int sentPackets = 0;
+    bool draining = false;
+    while (result.frames < maxFrames) {
+        if (!draining) {
+            int ret = av_read_frame(formatContext, packet);
+            if (ret < 0) {
+                draining = true;
+            } else if (packet->stream_index != streamIndex) {
+                av_packet_unref(packet);
+                continue;
+            }
+        }
+        auto start = std::chrono::steady_clock::now();
+        avcodec_send_packet(context, draining ? nullptr : packet);
+        if (!draining) {
+            ++sentPackets;
+        }
+        int ret = 0;
+        while ((ret = avcodec_receive_frame(context, frame)) >= 0) {
+            if (result.delayFrames < 0) {
+                result.delayFrames = sentPackets - 1;
+            }
+            ++result.frames;
+            av_frame_unref(frame);
+        }
+        result.seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        av_packet_unref(packet);
+        if (draining && ret == AVERROR_EOF) {
+            break;
+        }
+    }
+    av_frame_free(&frame);
+    av_packet_free(&packet);
+    avcodec_free_context(&context);
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s <media file> [max frames]\n", argv[0]);
+        return 1;
+    }
+    int maxFrames = argc > 2 ? atoi(argv[2]) : BENCH_DEFAULT_FRAMES;
+
+    AVFormatContext *formatContext = nullptr;
+    if (avformat_open_input(&formatContext, argv[1], nullptr, nullptr) < 0
+        || avformat_find_stream_info(formatContext, nullptr) < 0) {
+        fprintf(stderr, "failed to open %s\n", argv[1]);
+        avformat_close_input(&formatContext);
+        return 1;
+    }
+    int streamIndex = av_find_best_stream(formatContext, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    if (streamIndex < 0) {
+        fprintf(stderr, "no video stream\n");
+        avformat_close_input(&formatContext);
+        return 1;
+    }
+    AVCodecParameters *params = formatContext->streams[streamIndex]->codecpar;
+    printf("%s %dx%d, up to %d frames per configuration\n", avcodec_get_name(params->codec_id),
+           params->width, params->height, maxFrames);
+    printf("%-8s %-8s %8s %10s %8s %12s\n", "type", "threads", "actual", "fps", "speedup", "delay(frames)");
+
+    // 请求的多线程方式与 VideoCode::DecodeThreadType 对应
+    const struct {
+        const char *name;
+        int type;
+    } types[] = {{"frame", FF_THREAD_FRAME}, {"slice", FF_THREAD_SLICE}};
+    const int threadCounts[] = {1, 2, 4, 8};
+    double baseFps = 0.0;
+    for (const auto &type : types) {
+        for (int threadCount : threadCounts) {
+            Result result;
+            if (!decode(formatContext, streamIndex, threadCount, type.type, maxFrames, result) || result.seconds <= 0.0) {
+                printf("%-8s %-8d failed\n", type.name, threadCount);
+                continue;
+            }
+            double fps = result.frames / result.seconds;
+            if (baseFps <= 0.0) {
+                baseFps = fps;
+            }
+            const char *actual = result.threadType & FF_THREAD_FRAME ? "frame"
+                                 : result.threadType & FF_THREAD_SLICE ? "slice" : "single";
+            printf("%-8s %-8d %8s %10.1f %7.2fx %12d\n", type.name, threadCount, actual, fps, fps / baseFps,
+                   result.delayFrames);
+        }
+    }
+    avformat_close_input(&formatContext);
+    return 0;
+}
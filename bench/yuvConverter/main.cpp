@@ -0,0 +1,147 @@
+#include "../../s_function/unCode/YuvConverter.h"
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+extern "C" {
+#include <libavutil/frame.h>
+#include <libavutil/pixdesc.h>
+#include <libswscale/swscale.h>
+}
+
+#define BENCH_MIN_SECONDS 0.3 // 每轮至少计时的时长，帧数随之确定
+#define BENCH_ROUNDS 3 // 计时轮数，取最快的一轮，减少调度干扰
+
+namespace {
+
+struct Case {
+    AVPixelFormat format;
+    int srcWidth;
+    int srcHeight;
+    int dstWidth;
+    int dstHeight;
+};
+
+// 按格式填充随机像素，10 位格式只使用低 10 位
+AVFrame *makeFrame(AVPixelFormat format, int width, int height, std::mt19937 &rng)
+{
+    AVFrame *frame = av_frame_alloc();
+    frame->format = format;
+    frame->width = width;
+    frame->height = height;
+    if (av_frame_get_buffer(frame, 0) < 0) {
+        av_frame_free(&frame);
+        return nullptr;
+    }
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(format);
+    bool tenBit = desc->comp[0].depth > 8;
+    for (int plane = 0; plane < 4 && frame->data[plane]; ++plane) {
+        int rows = plane == 0 ? height : (height + 1) / 2;
+        for (int row = 0; row < rows; ++row) {
+            uint8_t *line = frame->data[plane] + (ptrdiff_t)row * frame->linesize[plane];
+            if (tenBit) {
+                uint16_t *samples = (uint16_t*)line;
+                for (int i = 0; i < frame->linesize[plane] / 2; ++i) {
+                    samples[i] = (uint16_t)(rng() & 0x3ff);
+                }
+            } else {
+                for (int i = 0; i < frame->linesize[plane]; ++i) {
+                    line[i] = (uint8_t)rng();
+                }
+            }
+        }
+    }
+    return frame;
+}
+
+// 每帧耗时（毫秒），取 BENCH_ROUNDS 轮中最快的一轮
+template<typename Convert>
+double measure(Convert convert)
+{
+    convert();
+    double best = 0.0;
+    for (int round = 0; round < BENCH_ROUNDS; ++round) {
+        int frames = 0;
+        auto start = std::chrono::steady_clock::now();
+        double seconds = 0.0;
+        do {
+            convert();
+            ++frames;
+            seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        } while (seconds < BENCH_MIN_SECONDS);
+        double ms = seconds * 1000.0 / frames;
+        if (round == 0 || ms < best) {
+            best = ms;
+        }
+    }
+    return best;
+}
+
+// swscale 转换一帧，flags 和输出格式决定对比的路径
+double measureSwscale(const AVFrame *frame, const Case &c, AVPixelFormat dstFormat, int flags)
+{
+    SwsContext *context = sws_getContext(c.srcWidth, c.srcHeight, c.format, c.dstWidth, c.dstHeight,
+                                         dstFormat, flags, nullptr, nullptr, nullptr);
+    if (!context) {
+        return -1.0;
+    }
+    int bytesPerPixel = dstFormat == AV_PIX_FMT_RGB24 ? 3 : 4;
+    std::vector<uint8_t> output((size_t)c.dstWidth * c.dstHeight * bytesPerPixel);
+    uint8_t *dstData[4] = {output.data(), nullptr, nullptr, nullptr};
+    int dstStride[4] = {c.dstWidth * bytesPerPixel, 0, 0, 0};
+    double ms = measure([&]() {
+        sws_scale(context, frame->data, frame->linesize, 0, c.srcHeight, dstData, dstStride);
+    });
+    sws_freeContext(context);
+    return ms;
+}
+
+} // namespace
+
+int main()
+{
+    const Case cases[] = {
+        {AV_PIX_FMT_YUV420P, 1280, 720, 1280, 720},
+        {AV_PIX_FMT_YUV420P, 1920, 1080, 1920, 1080},
+        {AV_PIX_FMT_NV12, 1920, 1080, 1920, 1080},
+        {AV_PIX_FMT_YUV420P10LE, 1920, 1080, 1920, 1080},
+        {AV_PIX_FMT_YUV420P, 1920, 1080, 1280, 720},
+        {AV_PIX_FMT_YUV420P, 3840, 2160, 3840, 2160},
+        {AV_PIX_FMT_YUV420P, 3840, 2160, 1280, 720},
+        {AV_PIX_FMT_YUV420P10LE, 3840, 2160, 1280, 720},
+    };
+    const char *kernelNames[] = {"scalar", "sse2", "avx2", "neon"};
+
+    std::mt19937 rng(20240501);
+    printf("ms/frame; swscale-bicubic = old RGB24 SWS_BICUBIC path, swscale-bilinear = RGB32 SWS_BILINEAR\n");
+    printf("%-12s %-22s %9s %9s %9s %9s %16s %17s\n", "format", "size", "scalar", "sse2", "avx2", "neon",
+           "swscale-bicubic", "swscale-bilinear");
+    for (const Case &c : cases) {
+        AVFrame *frame = makeFrame(c.format, c.srcWidth, c.srcHeight, rng);
+        if (!frame) {
+            continue;
+        }
+        char size[32];
+        snprintf(size, sizeof(size), "%dx%d->%dx%d", c.srcWidth, c.srcHeight, c.dstWidth, c.dstHeight);
+        printf("%-12s %-22s", av_get_pix_fmt_name(c.format), size);
+
+        YuvConverter converter;
+        std::vector<uint8_t> output((size_t)c.dstWidth * c.dstHeight * 4);
+        for (const char *name : kernelNames) {
+            if (!YuvConverter::setKernel(name)) {
+                printf(" %9s", "-");
+                continue;
+            }
+            double ms = measure([&]() {
+                converter.convert(frame, output.data(), c.dstWidth * 4, c.dstWidth, c.dstHeight);
+            });
+            printf(" %9.2f", ms);
+        }
+        printf(" %16.2f %17.2f\n", measureSwscale(frame, c, AV_PIX_FMT_RGB24, SWS_BICUBIC),
+               measureSwscale(frame, c, AV_PIX_FMT_RGB32, SWS_BILINEAR));
+        fflush(stdout);
+        av_frame_free(&frame);
+    }
+    return 0;
+}
@@ -0,0 +1,19 @@
+# YuvConverter 转换基准：标量 / SSE2 / AVX2 内核与 swscale 对比
+TEMPLATE = app
+TARGET = yuvConverterBench
+CONFIG += console c++17
+CONFIG -= app_bundle
+QT =
+
+SOURCES += \
+    $$PWD/main.cpp \
+    $$PWD/../../s_function/unCode/YuvConverter.cpp
+
+HEADERS += \
+    $$PWD/../../s_function/unCode/YuvConverter.h
+
+# FFmpeg 库配置，与主程序相同
+INCLUDEPATH += $$PWD/../../thirdParty/ffmpeg/include
+FFMPEG_LIB_DIR = $$PWD/../../thirdParty/ffmpeg/lib
+LIBS += -L$$FFMPEG_LIB_DIR/ -lavutil -lswscale
+QMAKE_RPATHDIR += $$shell_path($$FFMPEG_LIB_DIR)
@@ -137,17 +137,16 @@ Rectangle {
                         }
                         else if(videoFrame && !playButton.isPlaying){
                             playButton.isPlaying = true
-                            videoFrame.seekTo(currentDuration)
+                            videoFrame.seekToMs(Math.round(value * totalDuration * 10))
                             videoFrame.setPlaying(true)
                         }
                     }
                     
-                    // 拖拽进度条时跳转播放位置
+                    // 拖拽进度条时跳转播放位置：请求不阻塞界面，连续的请求只执行最后一个
                     onMoved: {
-                        // TODO: 调用后端接口跳转到指定位置
-                        // if (videoFrame) {
-                        //     videoFrame.seekTo(value)
-                        // }
+                        if (videoFrame) {
+                            videoFrame.seekToMs(Math.round(value * totalDuration * 10))
+                        }
                         currentDuration = value * totalDuration / 100
                     }
 
@@ -207,7 +206,17 @@ Rectangle {
                         { text: "1.0x", value: 1.0 },
                         { text: "1.25x", value: 1.25 },
                         { text: "1.5x", value: 1.5 },
-                        { text: "2.0x", value: 2.0 }
+                        { text: "2.0x", value: 2.0 },
+                        { text: "3.0x", value: 3.0 },
+                        { text: "4.0x", value: 4.0 },
+                        // 高于 4x 和负数为快进/快退：静音，只显示关键帧
+                        { text: "8x", value: 8.0 },
+                        { text: "16x", value: 16.0 },
+                        { text: "32x", value: 32.0 },
+                        { text: "-4x", value: -4.0 },
+                        { text: "-8x", value: -8.0 },
+                        { text: "-16x", value: -16.0 },
+                        { text: "-32x", value: -32.0 }
                     ]
                     
                     // 默认选择1.0x
@@ -11,7 +11,6 @@ EkhoTTS::EkhoTTS()
     , m_initialized(false)
     , m_sampleRate(0)
     , m_swrContext(nullptr)
-    , m_playQueueIndex(-1)
 {
 
 }
@@ -128,28 +127,47 @@ void EkhoTTS::addTextToQueue(const QString &text)
 {
     QMutexLocker locker(&m_textQueueMutex);
     m_textQueue.enqueue(text);
+    m_textQueueNotEmpty.wakeOne();
 }
 
 void EkhoTTS::run()
 {
-    m_playQueueIndex = AudioOutput::getInstance()->addThreadIdToPlayQueue(reinterpret_cast<qintptr>(QThread::currentThreadId()));
+    m_audioStream = AudioOutput::getInstance()->openStream();
     while (true) {
         QString text;
         {
             QMutexLocker locker(&m_textQueueMutex);
-            if (m_textQueue.isEmpty()) {
-                msleep(1);
-                continue;
+            while (m_textQueue.isEmpty()) {
+                m_textQueueNotEmpty.wait(&m_textQueueMutex);
             }
             text = m_textQueue.dequeue();
         }
         QByteArray audioData = synthesize(text);
         if (!audioData.isEmpty()) {
-            AudioOutput::getInstance()->addAudioDataToQueue(m_playQueueIndex, audioData);
+            writeAudio(audioData);
         }
     }
-    AudioOutput::getInstance()->removeThreadIdFromPlayQueue(m_playQueueIndex);
-    m_playQueueIndex = -1;
+    AudioOutput::getInstance()->closeStream(m_audioStream);
+    m_audioStream.reset();
+}
+
+void EkhoTTS::writeAudio(const QByteArray &audioData)
+{
+    const char *data = audioData.constData();
+    size_t remaining = static_cast<size_t>(audioData.size());
+    while (remaining > 0 && !m_audioStream->isClosed()) {
+        // 只写入缓冲区放得下的整样本，write() 不会截断丢弃
+        size_t chunk = qMin(remaining, m_audioStream->writableBytes());
+        chunk -= chunk % sizeof(short);
+        size_t written = chunk > 0 ? m_audioStream->write(data, chunk) : 0;
+        if (written == 0) {
+            // 缓冲区已满，等待混音线程取走数据
+            msleep(EKHO_TTS_WRITE_WAIT_MS);
+            continue;
+        }
+        data += written;
+        remaining -= written;
+    }
 }
 
 QByteArray EkhoTTS::synthesize(const QString &text)
@@ -6,6 +6,8 @@
 #include <QMutex>
 #include <QThread>
 #include <QQueue>
+#include <QWaitCondition>
+#include <memory>
 
 extern "C" {
 #include <libswresample/swresample.h>
@@ -17,6 +19,10 @@ extern "C" {
 
 #include <ekho.h>
 
+#define EKHO_TTS_WRITE_WAIT_MS 20 // 输出缓冲区已满时，等待混音线程取走数据的间隔
+
+class AudioStream;
+
 /**
  * @brief EkhoTTS 类用于通过文本合成中文语音音频数据
  * 
@@ -52,6 +58,8 @@ private:
     ~EkhoTTS();
 
     void run() override;
+    // 把整段语音写入输出流，缓冲区放不下时分段写入并等待混音线程腾出空间，不丢弃数据
+    void writeAudio(const QByteArray &audioData);
 
     // 禁止拷贝
     EkhoTTS(const EkhoTTS &) = delete;
@@ -85,8 +93,10 @@ private:
     QQueue<QString> m_textQueue;
     // 互斥锁，用于保护文本队列
     QMutex m_textQueueMutex;
-    // 音频队列索引
-    int m_playQueueIndex;
+    // 文本队列非空条件，队列为空时合成线程挂起而不是轮询
+    QWaitCondition m_textQueueNotEmpty;
+    // 合成语音的输出音频流
+    std::shared_ptr<AudioStream> m_audioStream;
 };
 
 #endif // EKHOTTS_H
@@ -0,0 +1,153 @@
+#ifndef DECODEBUDGET_H
+#define DECODEBUDGET_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief 解码预读预算（内存 + 时长）
+ *
+ * 与 SPSCLockFreeQueue 配合使用，完全由生产者线程维护：
+ * 生产者每次入队后调用 onPush() 登记该元素的字节数和时间戳，
+ * 再用队列的 size() 得到仍未被消费的元素个数，即可算出队列中
+ * 尚未消费的总字节数和时间跨度，消费者无需做任何额外登记。
+ *
+ * 注意事项：
+ * - Size 必须与所配合队列的容量一致（2的幂）
+ * - 只能由生产者线程调用 onPush()/queuedBytes()/queuedDurationMs()/isOverBudget()
+ * - 其他线程只能通过 publishedBytes()/publishedDurationMs() 读取统计，setLimits() 可在任意线程调用
+ * - 队列 reset() 时需要同时调用 reset()
+ */
+template<size_t Size>
+class DecodeBudget {
+    static_assert((Size & (Size - 1)) == 0, "Size must be power of 2");
+
+public:
+    DecodeBudget(int64_t maxBytes, int64_t maxAheadMs)
+        : m_maxBytes(maxBytes)
+        , m_maxAheadMs(maxAheadMs)
+    {
+        reset();
+    }
+
+    /**
+     * @brief 设置预算上限
+     * @param maxBytes 队列中最多缓存的字节数，<= 0 表示不限制
+     * @param maxAheadMs 队列中最多缓存的时长（毫秒），<= 0 表示不限制
+     */
+    void setLimits(int64_t maxBytes, int64_t maxAheadMs)
+    {
+        m_maxBytes.store(maxBytes, std::memory_order_relaxed);
+        m_maxAheadMs.store(maxAheadMs, std::memory_order_relaxed);
+    }
+
+    int64_t maxBytes() const { return m_maxBytes.load(std::memory_order_relaxed); }
+    int64_t maxAheadMs() const { return m_maxAheadMs.load(std::memory_order_relaxed); }
+
+    // 生产者最近一次检查预算时队列中尚未消费的字节数和时长（任意线程可调用）
+    int64_t publishedBytes() const { return m_publishedBytes.load(std::memory_order_relaxed); }
+    int64_t publishedDurationMs() const { return m_publishedDurationMs.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 登记一个已入队的元素（仅由生产者线程在 push 成功后调用）
+     * @param bytes 元素占用的字节数
+     * @param timestampMs 元素的时间戳（毫秒），未知时传入 -1
+     */
+    void onPush(int64_t bytes, int64_t timestampMs)
+    {
+        Entry &entry = m_entries[m_pushedCount & MASK];
+        entry.bytesBefore = m_pushedBytes;
+        entry.timestampMs = timestampMs;
+        m_pushedBytes += bytes;
+        ++m_pushedCount;
+    }
+
+    /**
+     * @brief 队列中尚未消费的字节数
+     * @param queued 队列当前的元素个数（队列的 size()）
+     */
+    int64_t queuedBytes(size_t queued) const
+    {
+        if (queued == 0 || queued > m_pushedCount) {
+            return 0;
+        }
+        const Entry &head = m_entries[(m_pushedCount - queued) & MASK];
+        return m_pushedBytes - head.bytesBefore;
+    }
+
+    /**
+     * @brief 队列中尚未消费的时长（毫秒），即队尾与队头时间戳之差
+     * @param queued 队列当前的元素个数（队列的 size()）
+     */
+    int64_t queuedDurationMs(size_t queued) const
+    {
+        if (queued == 0 || queued > m_pushedCount) {
+            return 0;
+        }
+        const Entry &head = m_entries[(m_pushedCount - queued) & MASK];
+        const Entry &tail = m_entries[(m_pushedCount - 1) & MASK];
+        if (head.timestampMs < 0 || tail.timestampMs < head.timestampMs) {
+            return 0;
+        }
+        return tail.timestampMs - head.timestampMs;
+    }
+
+    /**
+     * @brief 是否已超出预算，生产者应暂停解码；同时向其他线程发布当前统计
+     * @param queued 队列当前的元素个数（队列的 size()）
+     */
+    bool isOverBudget(size_t queued)
+    {
+        int64_t bytes = queuedBytes(queued);
+        int64_t durationMs = queuedDurationMs(queued);
+        m_publishedBytes.store(bytes, std::memory_order_relaxed);
+        m_publishedDurationMs.store(durationMs, std::memory_order_relaxed);
+
+        int64_t maxBytes = m_maxBytes.load(std::memory_order_relaxed);
+        int64_t maxAheadMs = m_maxAheadMs.load(std::memory_order_relaxed);
+        if (maxBytes > 0 && bytes >= maxBytes) {
+            return true;
+        }
+        if (maxAheadMs > 0 && durationMs >= maxAheadMs) {
+            return true;
+        }
+        return false;
+    }
+
+    /**
+     * @brief 重置统计（调用时生产者和消费者都应该停止操作）
+     */
+    void reset()
+    {
+        m_pushedCount = 0;
+        m_pushedBytes = 0;
+        m_publishedBytes.store(0, std::memory_order_relaxed);
+        m_publishedDurationMs.store(0, std::memory_order_relaxed);
+        for (size_t i = 0; i < Size; ++i) {
+            m_entries[i].bytesBefore = 0;
+            m_entries[i].timestampMs = -1;
+        }
+    }
+
+private:
+    struct Entry {
+        int64_t bytesBefore;   // 该元素入队前累计入队的字节数
+        int64_t timestampMs;   // 该元素的时间戳
+    };
+
+    static constexpr size_t MASK = Size - 1;
+
+    Entry m_entries[Size];
+    uint64_t m_pushedCount;
+    int64_t m_pushedBytes;
+
+    // 预算上限，可由其他线程修改
+    std::atomic<int64_t> m_maxBytes;
+    std::atomic<int64_t> m_maxAheadMs;
+    // 发布给其他线程的统计，只由生产者写入
+    std::atomic<int64_t> m_publishedBytes;
+    std::atomic<int64_t> m_publishedDurationMs;
+};
+
+#endif // DECODEBUDGET_H
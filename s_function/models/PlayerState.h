@@ -0,0 +1,209 @@
+#ifndef PLAYERSTATE_H
+#define PLAYERSTATE_H
+
+#include <atomic>
+#include <cstdint>
+#include "WaitEvent.h"
+
+/**
+ * @brief 播放器状态机，由渲染、解复用、音视频解码线程共享
+ *
+ * 状态、跳转完成后要回到的状态、跳转序号打包在同一个 64 位原子字中，
+ * 每个命令都是对这个字的一次 CAS，命令之间不需要加锁，也不会出现
+ * “检查状态之后、修改之前被其他线程改掉”的竞争：
+ *
+ * - Idle → Opening → Paused（打开失败回到 Idle）
+ * - Paused ⇄ Playing
+ * - Playing → Draining（解复用器读到文件末尾）→ Eof（已解码数据全部播完）
+ * - 任意已打开状态 → Seeking → 跳转前的状态（显示目标位置的第一帧后；Eof 跳转后停在 Paused）
+ *
+ * 工作线程不再在暂停时退出 run()，而是在 waitActive() 上挂起；
+ * 状态变化时唤醒所有挂起的线程，恢复播放只需要一次 futex 唤醒。
+ *
+ * 注意事项：
+ * - 命令可以由任意线程调用，状态查询无锁
+ * - 跳转序号只增不减，由 beginSeek() 递增，Demuxer 据此判断是否有新的跳转请求
+ * - requestQuit() 只用于关闭文件和析构，之后所有工作线程退出 run()
+ */
+class PlayerState
+{
+public:
+    enum State {
+        Idle,       // 没有打开文件，工作线程未运行
+        Opening,    // 正在打开文件
+        Playing,    // 正在播放
+        Paused,     // 已暂停，工作线程挂起
+        Seeking,    // 正在跳转，显示目标位置的第一帧后回到跳转前的状态
+        Draining,   // 文件已读完，正在播放剩余的已解码数据
+        Eof         // 播放结束，工作线程挂起，跳转后可以继续播放
+    };
+
+    PlayerState() : m_word(pack(Idle, Idle, 0)), m_quit(false) {}
+
+    PlayerState(const PlayerState &) = delete;
+    PlayerState &operator=(const PlayerState &) = delete;
+
+    State state() const { return stateOf(m_word.load(std::memory_order_acquire)); }
+    // 最新一次跳转请求的序号
+    int seekSerial() const { return serialOf(m_word.load(std::memory_order_acquire)); }
+
+    // 该状态下工作线程是否需要处理数据
+    static bool isActive(State state) { return state == Playing || state == Seeking || state == Draining; }
+    bool isActive() const { return isActive(state()); }
+    // 该状态下音频时钟是否走动
+    static bool isClockRunning(State state) { return state == Playing || state == Draining; }
+
+    /**
+     * @brief 当前状态为 from 时切换到 to
+     * @return false 当前状态不是 from，状态不变
+     */
+    bool transition(State from, State to)
+    {
+        uint64_t word = m_word.load(std::memory_order_acquire);
+        do {
+            if (stateOf(word) != from) {
+                return false;
+            }
+        } while (!m_word.compare_exchange_weak(word, pack(to, resumeOf(word), serialOf(word)),
+                                               std::memory_order_acq_rel));
+        m_changed.notify();
+        return true;
+    }
+
+    /**
+     * @brief 开始播放：Paused → Playing；跳转中则跳转完成后进入 Playing
+     * @return false 当前状态不能开始播放（未打开或已播放结束）
+     */
+    bool play()
+    {
+        uint64_t word = m_word.load(std::memory_order_acquire);
+        uint64_t next;
+        do {
+            State state = stateOf(word);
+            if (state == Paused) {
+                next = pack(Playing, Idle, serialOf(word));
+            } else if (state == Seeking) {
+                next = pack(Seeking, Playing, serialOf(word));
+            } else {
+                return isClockRunning(state);
+            }
+        } while (!m_word.compare_exchange_weak(word, next, std::memory_order_acq_rel));
+        m_changed.notify();
+        return true;
+    }
+
+    /**
+     * @brief 暂停：Playing/Draining → Paused；跳转中则跳转完成后进入 Paused
+     */
+    void pause()
+    {
+        uint64_t word = m_word.load(std::memory_order_acquire);
+        uint64_t next;
+        do {
+            State state = stateOf(word);
+            if (isClockRunning(state)) {
+                next = pack(Paused, Idle, serialOf(word));
+            } else if (state == Seeking) {
+                next = pack(Seeking, Paused, serialOf(word));
+            } else {
+                return;
+            }
+        } while (!m_word.compare_exchange_weak(word, next, std::memory_order_acq_rel));
+        m_changed.notify();
+    }
+
+    /**
+     * @brief 开始跳转，递增跳转序号并进入 Seeking
+     * @return 新的跳转序号；未打开文件时返回 -1
+     */
+    int beginSeek()
+    {
+        uint64_t word = m_word.load(std::memory_order_acquire);
+        uint64_t next;
+        do {
+            State state = stateOf(word);
+            if (state == Idle || state == Opening) {
+                return -1;
+            }
+            // 连续跳转时保留第一次跳转前的状态；播放中跳转完成后继续播放，其余情况停在目标帧上
+            State resume = state == Seeking ? resumeOf(word) : (isClockRunning(state) ? Playing : Paused);
+            next = pack(Seeking, resume, serialOf(word) + 1);
+        } while (!m_word.compare_exchange_weak(word, next, std::memory_order_acq_rel));
+        m_changed.notify();
+        return serialOf(next);
+    }
+
+    /**
+     * @brief 跳转完成（显示了序号为 serial 的第一帧），回到跳转前的状态
+     * @return false 该跳转已被更新的跳转取代，状态不变
+     */
+    bool finishSeek(int serial)
+    {
+        uint64_t word = m_word.load(std::memory_order_acquire);
+        do {
+            if (stateOf(word) != Seeking || serialOf(word) != serial) {
+                return false;
+            }
+        } while (!m_word.compare_exchange_weak(word, pack(resumeOf(word), Idle, serialOf(word)),
+                                               std::memory_order_acq_rel));
+        m_changed.notify();
+        return true;
+    }
+
+    // 切换到指定状态，保留跳转序号（用于打开、关闭文件）
+    void setState(State state)
+    {
+        uint64_t word = m_word.load(std::memory_order_acquire);
+        while (!m_word.compare_exchange_weak(word, pack(state, Idle, serialOf(word)),
+                                             std::memory_order_acq_rel)) {
+        }
+        m_changed.notify();
+    }
+
+    // 要求所有工作线程退出 run()
+    void requestQuit()
+    {
+        m_quit.store(true, std::memory_order_release);
+        m_changed.notify();
+    }
+    void resetQuit() { m_quit.store(false, std::memory_order_release); }
+    bool quitRequested() const { return m_quit.load(std::memory_order_acquire); }
+
+    /**
+     * @brief 不活动状态下挂起工作线程，状态变化、要求退出或超时后返回
+     * @return true 当前为活动状态，可以继续处理数据
+     */
+    bool waitActive(int64_t timeoutUs)
+    {
+        uint32_t token = m_changed.prepareWait();
+        if (isActive() || quitRequested()) {
+            m_changed.cancelWait();
+            return isActive();
+        }
+        m_changed.wait(token, timeoutUs);
+        return isActive();
+    }
+
+    static const char *name(State state)
+    {
+        static const char *const names[] = {"Idle", "Opening", "Playing", "Paused", "Seeking", "Draining", "Eof"};
+        return names[state];
+    }
+
+private:
+    // 低 8 位为状态，8~15 位为跳转完成后要回到的状态，高 32 位为跳转序号
+    static uint64_t pack(State state, State resume, int serial)
+    {
+        return (uint64_t)state | ((uint64_t)resume << 8) | ((uint64_t)(uint32_t)serial << 32);
+    }
+    static State stateOf(uint64_t word) { return (State)(word & 0xFF); }
+    static State resumeOf(uint64_t word) { return (State)((word >> 8) & 0xFF); }
+    static int serialOf(uint64_t word) { return (int)(uint32_t)(word >> 32); }
+
+    std::atomic<uint64_t> m_word;
+    std::atomic<bool> m_quit;
+    // 状态变化时唤醒挂起的工作线程
+    WaitEvent m_changed;
+};
+
+#endif // PLAYERSTATE_H
@@ -3,6 +3,7 @@
 
 #include <atomic>
 #include <cstddef>
+#include "WaitEvent.h"
 
 /**
  * @brief 单生产者单消费者无锁队列
@@ -24,8 +25,14 @@
  * - 只能有一个消费者线程调用 pop()
  * - 队列满时 push() 返回 false，需要处理
  * - 队列空时 pop() 返回 false，需要处理
+ *
+ * 阻塞模式（Blocking = true）：
+ * - 额外提供 waitPush()/waitPop()/waitForData()/waitForPop()，队列满/空时挂起线程而不是轮询
+ * - 只有对端真正挂起时 push()/pop() 才会进入内核唤醒，无竞争路径仍然是无锁的
+ * - close() 唤醒两端所有等待者，之后的等待立即返回
+ * - 非阻塞模式下上述等待接口不可用，push()/pop() 也不做任何唤醒操作
  */
-template<typename T, size_t Size>
+template<typename T, size_t Size, bool Blocking = false>
 class SPSCLockFreeQueue {
     static_assert((Size & (Size - 1)) == 0, "Size must be power of 2");
     static_assert(Size >= 2, "Size must be at least 2");
@@ -50,6 +57,14 @@ private:
     // 用于快速计算索引的掩码（Size必须是2的幂）
     static constexpr size_t MASK = Size - 1;
 
+    // 阻塞模式使用：消费者等待“非空”，生产者等待“有数据被取走”
+    WaitEvent m_notEmpty;
+    WaitEvent m_notFull;
+    std::atomic<bool> m_closed{false};
+
+    void notifyConsumer();
+    void notifyProducer();
+
 public:
     /**
      * @brief 构造函数
@@ -93,6 +108,14 @@ public:
      */
     bool front(T& item) const;
 
+    /**
+     * @brief 获取队头元素的指针（仅由消费者线程调用，不拷贝、不弹出）
+     * @return 队头元素指针，队列为空时返回 nullptr
+     * @note 指针在下一次 pop()/tryPop()/clear() 之前有效
+     */
+    T* peek();
+    const T* peek() const;
+
     /**
      * @brief 检查队列是否为空（仅由消费者线程调用）
      * @return true 队列为空，false 队列有数据
@@ -118,6 +141,53 @@ public:
      */
     constexpr size_t capacity() const;
 
+    /**
+     * @brief 阻塞入队（仅由生产者线程调用，仅阻塞模式可用）
+     * @param item 要入队的数据
+     * @param timeoutMs 超时时间（毫秒），< 0 表示一直等待，0 表示不等待
+     * @return true 成功，false 超时或队列已关闭
+     */
+    bool waitPush(const T& item, int timeoutMs = -1);
+    bool waitPush(T&& item, int timeoutMs = -1);
+
+    /**
+     * @brief 阻塞出队（仅由消费者线程调用，仅阻塞模式可用）
+     * @param item 出队的数据
+     * @param timeoutMs 超时时间（毫秒），< 0 表示一直等待，0 表示不等待
+     * @return true 成功，false 超时或队列已关闭且为空
+     */
+    bool waitPop(T& item, int timeoutMs = -1);
+
+    /**
+     * @brief 等待队列非空（仅由消费者线程调用，仅阻塞模式可用）
+     * @return true 队列非空，false 超时、队列已关闭或被 notifyAll() 唤醒
+     */
+    bool waitForData(int timeoutMs = -1);
+
+    /**
+     * @brief 同 waitForData()，超时以微秒为单位，用于需要亚毫秒精度的定时等待
+     */
+    bool waitForDataUs(int64_t timeoutUs);
+
+    /**
+     * @brief 等待消费者取走至少一个元素（仅由生产者线程调用，仅阻塞模式可用）
+     * @note 用于生产者按预算（而不是按队列满）限流的场景
+     * @return true 有元素被取走，false 超时、队列已关闭或被 notifyAll() 唤醒
+     */
+    bool waitForPop(int timeoutMs = -1);
+
+    /**
+     * @brief 关闭队列并唤醒两端所有等待者，之后的等待操作立即返回 false
+     * @note 关闭后仍可 pop() 取出剩余数据，reset() 会重新打开队列
+     */
+    void close();
+    bool isClosed() const;
+
+    /**
+     * @brief 唤醒两端所有等待者（不关闭队列），用于等待者需要重新检查外部状态的场景
+     */
+    void notifyAll();
+
     /**
      * @brief 清空队列（仅由消费者线程调用）
      */
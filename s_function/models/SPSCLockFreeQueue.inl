@@ -1,15 +1,15 @@
 // SPSCLockFreeQueue.inl - 模板实现文件
 
-template<typename T, size_t Size>
-SPSCLockFreeQueue<T, Size>::SPSCLockFreeQueue() {
+template<typename T, size_t Size, bool Blocking>
+SPSCLockFreeQueue<T, Size, Blocking>::SPSCLockFreeQueue() {
     // 初始化所有槽位为未就绪状态
     for (size_t i = 0; i < Size; ++i) {
         buffer[i].ready.store(false, std::memory_order_relaxed);
     }
 }
 
-template<typename T, size_t Size>
-bool SPSCLockFreeQueue<T, Size>::push(const T& item) {
+template<typename T, size_t Size, bool Blocking>
+bool SPSCLockFreeQueue<T, Size, Blocking>::push(const T& item) {
     size_t current_write = write_pos.load(std::memory_order_relaxed);
     size_t index = current_write & MASK;
     Slot& slot = buffer[index];
@@ -30,12 +30,15 @@ bool SPSCLockFreeQueue<T, Size>::push(const T& item) {
     
     // 更新写位置（使用 relaxed，因为只有生产者线程修改）
     write_pos.store(current_write + 1, std::memory_order_relaxed);
+
+    // 阻塞模式下，消费者挂起时才唤醒
+    notifyConsumer();
     
     return true;
 }
 
-template<typename T, size_t Size>
-bool SPSCLockFreeQueue<T, Size>::push(T&& item) {
+template<typename T, size_t Size, bool Blocking>
+bool SPSCLockFreeQueue<T, Size, Blocking>::push(T&& item) {
     size_t current_write = write_pos.load(std::memory_order_relaxed);
     size_t index = current_write & MASK;
     Slot& slot = buffer[index];
@@ -47,12 +50,13 @@ bool SPSCLockFreeQueue<T, Size>::push(T&& item) {
     slot.data = std::move(item);
     slot.ready.store(true, std::memory_order_release);
     write_pos.store(current_write + 1, std::memory_order_relaxed);
+    notifyConsumer();
     
     return true;
 }
 
-template<typename T, size_t Size>
-bool SPSCLockFreeQueue<T, Size>::pop(T& item) {
+template<typename T, size_t Size, bool Blocking>
+bool SPSCLockFreeQueue<T, Size, Blocking>::pop(T& item) {
     size_t current_read = read_pos.load(std::memory_order_relaxed);
     size_t index = current_read & MASK;
     Slot& slot = buffer[index];
@@ -73,17 +77,20 @@ bool SPSCLockFreeQueue<T, Size>::pop(T& item) {
     
     // 更新读位置（使用 relaxed，因为只有消费者线程修改）
     read_pos.store(current_read + 1, std::memory_order_relaxed);
+
+    // 阻塞模式下，生产者挂起时才唤醒
+    notifyProducer();
     
     return true;
 }
 
-template<typename T, size_t Size>
-bool SPSCLockFreeQueue<T, Size>::tryPop(T& item) {
+template<typename T, size_t Size, bool Blocking>
+bool SPSCLockFreeQueue<T, Size, Blocking>::tryPop(T& item) {
     return pop(item);
 }
 
-template<typename T, size_t Size>
-bool SPSCLockFreeQueue<T, Size>::front(T& item) const {
+template<typename T, size_t Size, bool Blocking>
+bool SPSCLockFreeQueue<T, Size, Blocking>::front(T& item) const {
     // 获取当前读位置（但不修改，因为这是 const 函数）
     size_t current_read = read_pos.load(std::memory_order_acquire);
     size_t index = current_read & MASK;
@@ -103,24 +110,40 @@ bool SPSCLockFreeQueue<T, Size>::front(T& item) const {
     return true;
 }
 
-template<typename T, size_t Size>
-bool SPSCLockFreeQueue<T, Size>::empty() const {
+template<typename T, size_t Size, bool Blocking>
+T* SPSCLockFreeQueue<T, Size, Blocking>::peek() {
+    size_t current_read = read_pos.load(std::memory_order_acquire);
+    Slot& slot = buffer[current_read & MASK];
+    // acquire 保证看到生产者写入的数据
+    if (!slot.ready.load(std::memory_order_acquire)) {
+        return nullptr;
+    }
+    return &slot.data;
+}
+
+template<typename T, size_t Size, bool Blocking>
+const T* SPSCLockFreeQueue<T, Size, Blocking>::peek() const {
+    return const_cast<SPSCLockFreeQueue*>(this)->peek();
+}
+
+template<typename T, size_t Size, bool Blocking>
+bool SPSCLockFreeQueue<T, Size, Blocking>::empty() const {
     size_t current_read = read_pos.load(std::memory_order_acquire);
     size_t index = current_read & MASK;
     const Slot& slot = buffer[index];
     return !slot.ready.load(std::memory_order_acquire);
 }
 
-template<typename T, size_t Size>
-bool SPSCLockFreeQueue<T, Size>::full() const {
+template<typename T, size_t Size, bool Blocking>
+bool SPSCLockFreeQueue<T, Size, Blocking>::full() const {
     size_t current_write = write_pos.load(std::memory_order_relaxed);
     size_t index = current_write & MASK;
     const Slot& slot = buffer[index];
     return slot.ready.load(std::memory_order_acquire);
 }
 
-template<typename T, size_t Size>
-size_t SPSCLockFreeQueue<T, Size>::size() const {
+template<typename T, size_t Size, bool Blocking>
+size_t SPSCLockFreeQueue<T, Size, Blocking>::size() const {
     size_t w = write_pos.load(std::memory_order_acquire);
     size_t r = read_pos.load(std::memory_order_acquire);
     
@@ -131,21 +154,21 @@ size_t SPSCLockFreeQueue<T, Size>::size() const {
     return 0;
 }
 
-template<typename T, size_t Size>
-constexpr size_t SPSCLockFreeQueue<T, Size>::capacity() const {
+template<typename T, size_t Size, bool Blocking>
+constexpr size_t SPSCLockFreeQueue<T, Size, Blocking>::capacity() const {
     return Size;
 }
 
-template<typename T, size_t Size>
-void SPSCLockFreeQueue<T, Size>::clear() {
+template<typename T, size_t Size, bool Blocking>
+void SPSCLockFreeQueue<T, Size, Blocking>::clear() {
     T dummy;
     while (pop(dummy)) {
         // 清空所有数据
     }
 }
 
-template<typename T, size_t Size>
-void SPSCLockFreeQueue<T, Size>::reset() {
+template<typename T, size_t Size, bool Blocking>
+void SPSCLockFreeQueue<T, Size, Blocking>::reset() {
     // 清空所有数据
     clear();
     
@@ -157,5 +180,130 @@ void SPSCLockFreeQueue<T, Size>::reset() {
     for (size_t i = 0; i < Size; ++i) {
         buffer[i].ready.store(false, std::memory_order_relaxed);
     }
+
+    m_closed.store(false, std::memory_order_release);
+}
+
+template<typename T, size_t Size, bool Blocking>
+void SPSCLockFreeQueue<T, Size, Blocking>::notifyConsumer() {
+    if (Blocking) {
+        m_notEmpty.notify();
+    }
+}
+
+template<typename T, size_t Size, bool Blocking>
+void SPSCLockFreeQueue<T, Size, Blocking>::notifyProducer() {
+    if (Blocking) {
+        m_notFull.notify();
+    }
+}
+
+template<typename T, size_t Size, bool Blocking>
+bool SPSCLockFreeQueue<T, Size, Blocking>::waitPush(const T& item, int timeoutMs) {
+    static_assert(Blocking, "waitPush requires a blocking queue");
+    if (push(item)) {
+        return true;
+    }
+    if (timeoutMs == 0) {
+        return false;
+    }
+    uint32_t token = m_notFull.prepareWait();
+    // 登记后再检查一次，避免错过消费者的唤醒
+    if (!full() || isClosed()) {
+        m_notFull.cancelWait();
+    } else {
+        m_notFull.wait(token, WaitEvent::toTimeoutUs(timeoutMs));
+    }
+    return !isClosed() && push(item);
+}
+
+template<typename T, size_t Size, bool Blocking>
+bool SPSCLockFreeQueue<T, Size, Blocking>::waitPush(T&& item, int timeoutMs) {
+    static_assert(Blocking, "waitPush requires a blocking queue");
+    if (push(std::move(item))) {
+        return true;
+    }
+    if (timeoutMs == 0) {
+        return false;
+    }
+    uint32_t token = m_notFull.prepareWait();
+    if (!full() || isClosed()) {
+        m_notFull.cancelWait();
+    } else {
+        m_notFull.wait(token, WaitEvent::toTimeoutUs(timeoutMs));
+    }
+    // push 失败时不会移动 item，可以安全地再次尝试
+    return !isClosed() && push(std::move(item));
+}
+
+template<typename T, size_t Size, bool Blocking>
+bool SPSCLockFreeQueue<T, Size, Blocking>::waitPop(T& item, int timeoutMs) {
+    static_assert(Blocking, "waitPop requires a blocking queue");
+    if (pop(item)) {
+        return true;
+    }
+    if (timeoutMs != 0) {
+        waitForData(timeoutMs);
+    }
+    // 关闭后仍允许取出剩余数据
+    return pop(item);
+}
+
+template<typename T, size_t Size, bool Blocking>
+bool SPSCLockFreeQueue<T, Size, Blocking>::waitForData(int timeoutMs) {
+    return waitForDataUs(WaitEvent::toTimeoutUs(timeoutMs));
+}
+
+template<typename T, size_t Size, bool Blocking>
+bool SPSCLockFreeQueue<T, Size, Blocking>::waitForDataUs(int64_t timeoutUs) {
+    static_assert(Blocking, "waitForData requires a blocking queue");
+    if (!empty()) {
+        return true;
+    }
+    if (timeoutUs == 0 || isClosed()) {
+        return false;
+    }
+    uint32_t token = m_notEmpty.prepareWait();
+    // 登记后再检查一次，避免错过生产者的唤醒
+    if (!empty() || isClosed()) {
+        m_notEmpty.cancelWait();
+    } else {
+        m_notEmpty.wait(token, timeoutUs);
+    }
+    return !empty();
+}
+
+template<typename T, size_t Size, bool Blocking>
+bool SPSCLockFreeQueue<T, Size, Blocking>::waitForPop(int timeoutMs) {
+    static_assert(Blocking, "waitForPop requires a blocking queue");
+    if (timeoutMs == 0 || isClosed()) {
+        return false;
+    }
+    size_t start = read_pos.load(std::memory_order_acquire);
+    uint32_t token = m_notFull.prepareWait();
+    if (read_pos.load(std::memory_order_acquire) != start || isClosed()) {
+        m_notFull.cancelWait();
+    } else {
+        m_notFull.wait(token, WaitEvent::toTimeoutUs(timeoutMs));
+    }
+    return read_pos.load(std::memory_order_acquire) != start;
+}
+
+template<typename T, size_t Size, bool Blocking>
+void SPSCLockFreeQueue<T, Size, Blocking>::close() {
+    m_closed.store(true, std::memory_order_release);
+    m_notEmpty.wake();
+    m_notFull.wake();
+}
+
+template<typename T, size_t Size, bool Blocking>
+bool SPSCLockFreeQueue<T, Size, Blocking>::isClosed() const {
+    return m_closed.load(std::memory_order_acquire);
+}
+
+template<typename T, size_t Size, bool Blocking>
+void SPSCLockFreeQueue<T, Size, Blocking>::notifyAll() {
+    m_notEmpty.wake();
+    m_notFull.wake();
 }
 
@@ -0,0 +1,99 @@
+#ifndef SPSCRINGQUEUE_H
+#define SPSCRINGQUEUE_H
+
+#include <atomic>
+#include <cstddef>
+
+/**
+ * @brief 单生产者单消费者无锁环形队列（缓存索引）
+ *
+ * 与 SPSCLockFreeQueue 的区别：
+ * - 不使用每个槽位的 ready 标志，而是只用读/写两个索引判断空满
+ * - 生产者缓存一份读索引、消费者缓存一份写索引，只有缓存值显示
+ *   “满/空”时才去读对端的原子索引
+ * - 槽位紧密排列，只有两个索引按缓存行对齐，避免伪共享
+ *
+ * 注意事项：
+ * - 队列大小必须是2的幂
+ * - 只能有一个生产者线程调用 push()
+ * - 只能有一个消费者线程调用 pop()/peek()
+ */
+template<typename T, size_t Size>
+class SPSCRingQueue {
+    static_assert((Size & (Size - 1)) == 0, "Size must be power of 2");
+    static_assert(Size >= 2, "Size must be at least 2");
+
+private:
+    // 用于快速计算索引的掩码（Size必须是2的幂）
+    static constexpr size_t MASK = Size - 1;
+
+    T buffer[Size];
+
+    // 消费者缓存行：读位置 + 消费者缓存的写位置
+    alignas(64) std::atomic<size_t> m_head{0};
+    size_t m_cachedTail = 0;
+
+    // 生产者缓存行：写位置 + 生产者缓存的读位置
+    alignas(64) std::atomic<size_t> m_tail{0};
+    size_t m_cachedHead = 0;
+
+    // 生产者可写入的元素个数（必要时刷新缓存的读位置）
+    size_t writableCount(size_t tail, size_t wanted);
+    // 消费者可读取的元素个数（必要时刷新缓存的写位置）
+    size_t readableCount(size_t head, size_t wanted);
+
+public:
+    SPSCRingQueue() = default;
+
+    /**
+     * @brief 入队（仅由生产者线程调用）
+     * @return true 成功，false 队列已满
+     */
+    bool push(const T& item);
+    bool push(T&& item);
+
+    /**
+     * @brief 出队（仅由消费者线程调用）
+     * @return true 成功，false 队列为空
+     */
+    bool pop(T& item);
+
+    /**
+     * @brief 获取队头元素的指针，不拷贝、不弹出（仅由消费者线程调用）
+     * @return 队头元素指针，队列为空时返回 nullptr
+     * @note 指针在下一次 pop()/clear() 之前有效
+     */
+    T* peek();
+
+    /**
+     * @brief 检查队列是否为空（仅由消费者线程调用）
+     */
+    bool empty() const;
+
+    /**
+     * @brief 检查队列是否已满（仅由生产者线程调用）
+     */
+    bool full() const;
+
+    /**
+     * @brief 获取队列中元素数量（近似值）
+     */
+    size_t size() const;
+
+    constexpr size_t capacity() const { return Size; }
+
+    /**
+     * @brief 清空队列（仅由消费者线程调用）
+     */
+    void clear();
+
+    /**
+     * @brief 重置队列（调用时生产者和消费者都应该停止操作）
+     */
+    void reset();
+};
+
+// 包含实现文件
+#include "SPSCRingQueue.inl"
+
+#endif // SPSCRINGQUEUE_H
@@ -0,0 +1,106 @@
+
+// SPSCRingQueue.inl - 模板实现文件
+
+#include <utility>
+
+template<typename T, size_t Size>
+size_t SPSCRingQueue<T, Size>::writableCount(size_t tail, size_t wanted) {
+    size_t freeCount = Size - (tail - m_cachedHead);
+    if (freeCount < wanted) {
+        // 缓存的读位置显示空间不足时，才去读取消费者的原子索引
+        m_cachedHead = m_head.load(std::memory_order_acquire);
+        freeCount = Size - (tail - m_cachedHead);
+    }
+    return freeCount;
+}
+
+template<typename T, size_t Size>
+size_t SPSCRingQueue<T, Size>::readableCount(size_t head, size_t wanted) {
+    size_t available = m_cachedTail - head;
+    if (available < wanted) {
+        // 缓存的写位置显示数据不足时，才去读取生产者的原子索引
+        m_cachedTail = m_tail.load(std::memory_order_acquire);
+        available = m_cachedTail - head;
+    }
+    return available;
+}
+
+template<typename T, size_t Size>
+bool SPSCRingQueue<T, Size>::push(const T& item) {
+    size_t tail = m_tail.load(std::memory_order_relaxed);
+    if (writableCount(tail, 1) == 0) {
+        return false;
+    }
+    buffer[tail & MASK] = item;
+    // release：消费者看到新的写位置时，数据已经写入完成
+    m_tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+template<typename T, size_t Size>
+bool SPSCRingQueue<T, Size>::push(T&& item) {
+    size_t tail = m_tail.load(std::memory_order_relaxed);
+    if (writableCount(tail, 1) == 0) {
+        return false;
+    }
+    buffer[tail & MASK] = std::move(item);
+    m_tail.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+template<typename T, size_t Size>
+bool SPSCRingQueue<T, Size>::pop(T& item) {
+    size_t head = m_head.load(std::memory_order_relaxed);
+    if (readableCount(head, 1) == 0) {
+        return false;
+    }
+    item = std::move(buffer[head & MASK]);
+    // release：生产者看到新的读位置时，数据已经读取完成，槽位可以复用
+    m_head.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+template<typename T, size_t Size>
+T* SPSCRingQueue<T, Size>::peek() {
+    size_t head = m_head.load(std::memory_order_relaxed);
+    if (readableCount(head, 1) == 0) {
+        return nullptr;
+    }
+    return &buffer[head & MASK];
+}
+
+template<typename T, size_t Size>
+bool SPSCRingQueue<T, Size>::empty() const {
+    return m_tail.load(std::memory_order_acquire) == m_head.load(std::memory_order_relaxed);
+}
+
+template<typename T, size_t Size>
+bool SPSCRingQueue<T, Size>::full() const {
+    return m_tail.load(std::memory_order_relaxed) - m_head.load(std::memory_order_acquire) >= Size;
+}
+
+template<typename T, size_t Size>
+size_t SPSCRingQueue<T, Size>::size() const {
+    size_t head = m_head.load(std::memory_order_acquire);
+    size_t tail = m_tail.load(std::memory_order_acquire);
+    // 两次读取之间对端可能推进，只返回合理范围内的值
+    size_t count = tail - head;
+    return count > Size ? Size : count;
+}
+
+template<typename T, size_t Size>
+void SPSCRingQueue<T, Size>::clear() {
+    T dummy;
+    while (pop(dummy)) {
+        // 清空所有数据，释放元素持有的资源
+    }
+}
+
+template<typename T, size_t Size>
+void SPSCRingQueue<T, Size>::reset() {
+    clear();
+    m_head.store(0, std::memory_order_relaxed);
+    m_tail.store(0, std::memory_order_relaxed);
+    m_cachedHead = 0;
+    m_cachedTail = 0;
+}
@@ -0,0 +1,76 @@
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include <atomic>
+#include <cstdint>
+
+/**
+ * @brief 单生产者单消费者无锁三缓冲（最新值信箱）
+ *
+ * 与队列不同，三缓冲只保留最新发布的值：
+ * - 生产者写入自己独占的后台槽位，发布时与中间槽位原子交换
+ * - 消费者取值时把中间槽位与自己独占的前台槽位原子交换
+ * 双方都不会阻塞，消费者来不及取走的旧值直接被新值覆盖，
+ * 适合“只关心最新一帧”的场景，例如渲染线程向界面提交视频帧。
+ *
+ * 注意事项：
+ * - 只能有一个生产者线程调用 publish()
+ * - 只能有一个消费者线程调用 take()
+ * - 被覆盖的值在下一次 publish() 写入该槽位时才析构
+ */
+template<typename T>
+class TripleBuffer {
+private:
+    struct Slot {
+        T value;
+        // 发布序号，用于统计被覆盖的个数
+        uint64_t sequence = 0;
+    };
+
+    // 状态字节：低2位为中间槽位下标，FRESH 位表示中间槽位有未取走的新值
+    static constexpr uint8_t INDEX_MASK = 0x03;
+    static constexpr uint8_t FRESH = 0x04;
+
+    Slot m_slots[3];
+
+    alignas(64) std::atomic<uint8_t> m_state{1};
+
+    // 生产者独占
+    alignas(64) uint8_t m_back = 0;
+    uint64_t m_publishSequence = 0;
+
+    // 消费者独占
+    alignas(64) uint8_t m_front = 2;
+    uint64_t m_takeSequence = 0;
+
+public:
+    TripleBuffer() = default;
+
+    TripleBuffer(const TripleBuffer &) = delete;
+    TripleBuffer &operator=(const TripleBuffer &) = delete;
+
+    /**
+     * @brief 发布新值（仅由生产者线程调用）
+     * @return true 覆盖了一个消费者尚未取走的值
+     */
+    bool publish(const T& item);
+    bool publish(T&& item);
+
+    /**
+     * @brief 取走最新值（仅由消费者线程调用）
+     * @param item 取出的值
+     * @param skipped 可选，输出自上次取值以来被覆盖、未被取走的个数
+     * @return true 取到新值，false 自上次取值以来没有新发布
+     */
+    bool take(T& item, uint64_t *skipped = nullptr);
+
+    /**
+     * @brief 是否有未取走的新值（任意线程可调用，近似值）
+     */
+    bool hasNew() const;
+};
+
+// 包含实现文件
+#include "TripleBuffer.inl"
+
+#endif // TRIPLEBUFFER_H
@@ -0,0 +1,44 @@
+
+// TripleBuffer.inl - 模板实现文件
+
+#include <utility>
+
+template<typename T>
+bool TripleBuffer<T>::publish(const T& item) {
+    T copy(item);
+    return publish(std::move(copy));
+}
+
+template<typename T>
+bool TripleBuffer<T>::publish(T&& item) {
+    Slot &slot = m_slots[m_back];
+    slot.value = std::move(item);
+    slot.sequence = ++m_publishSequence;
+    // acq_rel：release 发布本槽位的写入，acquire 取得消费者归还的槽位
+    uint8_t old = m_state.exchange(static_cast<uint8_t>(m_back | FRESH), std::memory_order_acq_rel);
+    m_back = old & INDEX_MASK;
+    return (old & FRESH) != 0;
+}
+
+template<typename T>
+bool TripleBuffer<T>::take(T& item, uint64_t *skipped) {
+    if (!(m_state.load(std::memory_order_relaxed) & FRESH)) {
+        return false;
+    }
+    // 归还前台槽位，取得中间槽位；FRESH 位同时清除
+    uint8_t old = m_state.exchange(m_front, std::memory_order_acq_rel);
+    m_front = old & INDEX_MASK;
+
+    Slot &slot = m_slots[m_front];
+    if (skipped) {
+        *skipped = slot.sequence - m_takeSequence - 1;
+    }
+    m_takeSequence = slot.sequence;
+    item = std::move(slot.value);
+    return true;
+}
+
+template<typename T>
+bool TripleBuffer<T>::hasNew() const {
+    return (m_state.load(std::memory_order_acquire) & FRESH) != 0;
+}
@@ -0,0 +1,154 @@
+#ifndef WAITEVENT_H
+#define WAITEVENT_H
+
+#include <atomic>
+#include <cstdint>
+#include <chrono>
+
+#if defined(__linux__)
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <ctime>
+#else
+#include <mutex>
+#include <condition_variable>
+#endif
+
+/**
+ * @brief 轻量级等待/唤醒事件（Linux 下基于 futex）
+ *
+ * 用于在无锁数据结构上实现“空/满时阻塞”，正确的使用顺序为：
+ *
+ *   等待方：
+ *     uint32_t token = event.prepareWait();   // 登记为等待者
+ *     if (条件已满足) { event.cancelWait(); ... }
+ *     else event.wait(token, timeoutUs);       // 真正挂起
+ *
+ *   通知方：
+ *     修改共享状态（release 写入）;
+ *     event.notify();                         // 只有存在等待者时才进入内核
+ *
+ * 特点：
+ * - 没有线程挂起时 notify() 只是一次内存屏障加一次原子读，不进入内核
+ * - prepareWait() 之后发生的 notify() 一定不会丢失
+ * - wait() 可能虚假唤醒，调用方需要在循环中重新检查条件
+ */
+class WaitEvent
+{
+public:
+    WaitEvent() : m_sequence(0), m_waiters(0) {}
+
+    WaitEvent(const WaitEvent &) = delete;
+    WaitEvent &operator=(const WaitEvent &) = delete;
+
+    /**
+     * @brief 登记为等待者，返回当前序号
+     * @note 之后必须调用 wait() 或 cancelWait() 之一
+     */
+    uint32_t prepareWait()
+    {
+        m_waiters.fetch_add(1, std::memory_order_seq_cst);
+        // 与 notify() 中的屏障配对：要么通知方看到等待者，要么等待方看到新状态
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        return m_sequence.load(std::memory_order_acquire);
+    }
+
+    /**
+     * @brief 条件已经满足，放弃等待
+     */
+    void cancelWait()
+    {
+        m_waiters.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief 挂起直到被通知或超时
+     * @param token prepareWait() 的返回值
+     * @param timeoutUs 超时时间（微秒），< 0 表示一直等待
+     * @return true 被通知（或虚假唤醒），false 超时
+     */
+    bool wait(uint32_t token, int64_t timeoutUs)
+    {
+        bool notified = true;
+#if defined(__linux__)
+        if (m_sequence.load(std::memory_order_acquire) == token) {
+            struct timespec timeout;
+            struct timespec *timeoutPtr = nullptr;
+            if (timeoutUs >= 0) {
+                timeout.tv_sec = static_cast<time_t>(timeoutUs / 1000000);
+                timeout.tv_nsec = static_cast<long>((timeoutUs % 1000000) * 1000);
+                timeoutPtr = &timeout;
+            }
+            long ret = syscall(SYS_futex, reinterpret_cast<uint32_t *>(&m_sequence),
+                               FUTEX_WAIT_PRIVATE, token, timeoutPtr, nullptr, 0);
+            if (ret != 0 && m_sequence.load(std::memory_order_acquire) == token) {
+                // ETIMEDOUT 或 EINTR；序号未变化时按超时处理
+                notified = (timeoutUs < 0);
+            }
+        }
+#else
+        std::unique_lock<std::mutex> locker(m_mutex);
+        auto changed = [this, token]() { return m_sequence.load(std::memory_order_acquire) != token; };
+        if (timeoutUs < 0) {
+            m_condition.wait(locker, changed);
+        } else {
+            notified = m_condition.wait_for(locker, std::chrono::microseconds(timeoutUs), changed);
+        }
+#endif
+        m_waiters.fetch_sub(1, std::memory_order_relaxed);
+        return notified;
+    }
+
+    /**
+     * @brief 唤醒所有等待者（只有存在等待者时才进入内核）
+     */
+    void notify()
+    {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_waiters.load(std::memory_order_relaxed) == 0) {
+            return;
+        }
+        wake();
+    }
+
+    /**
+     * @brief 无条件唤醒所有等待者，用于关闭、停止等低频场景
+     */
+    void wake()
+    {
+#if defined(__linux__)
+        m_sequence.fetch_add(1, std::memory_order_release);
+        syscall(SYS_futex, reinterpret_cast<uint32_t *>(&m_sequence),
+                FUTEX_WAKE_PRIVATE, INT32_MAX, nullptr, nullptr, 0);
+#else
+        {
+            std::lock_guard<std::mutex> locker(m_mutex);
+            m_sequence.fetch_add(1, std::memory_order_release);
+        }
+        m_condition.notify_all();
+#endif
+    }
+
+    /**
+     * @brief 将“毫秒超时”转换为 wait() 使用的微秒超时，< 0 表示一直等待
+     */
+    static int64_t toTimeoutUs(int timeoutMs)
+    {
+        return timeoutMs < 0 ? -1 : static_cast<int64_t>(timeoutMs) * 1000;
+    }
+
+private:
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex word must be 32-bit");
+
+    // futex 字：每次唤醒加一
+    std::atomic<uint32_t> m_sequence;
+    // 已登记的等待者数量
+    std::atomic<uint32_t> m_waiters;
+#if !defined(__linux__)
+    std::mutex m_mutex;
+    std::condition_variable m_condition;
+#endif
+};
+
+#endif // WAITEVENT_H
@@ -1,8 +1,15 @@
 HEADERS += \
     $$PWD/BaseModelCtrl.h \
-    $$PWD/SPSCLockFreeQueue.h
+    $$PWD/DecodeBudget.h \
+    $$PWD/PlayerState.h \
+    $$PWD/SPSCLockFreeQueue.h \
+    $$PWD/SPSCRingQueue.h \
+    $$PWD/TripleBuffer.h \
+    $$PWD/WaitEvent.h
 
 SOURCES +=
 
 DISTFILES += \
-    $$PWD/SPSCLockFreeQueue.inl
+    $$PWD/SPSCLockFreeQueue.inl \
+    $$PWD/SPSCRingQueue.inl \
+    $$PWD/TripleBuffer.inl
@@ -0,0 +1,184 @@
+#include "AudioMixer.h"
+#include <cmath>
+#include <cstring>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define AUDIO_MIXER_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+typedef void (*AccumulateFunc)(float *acc, const int16_t *src, int count, float gainStart, float step);
+typedef void (*PackFunc)(int16_t *dst, const float *acc, int count);
+
+struct MixerKernels {
+    AccumulateFunc accumulate;
+    PackFunc pack;
+    const char *name;
+};
+
+// 标量实现，同时用于 SIMD 实现处理尾部样本
+void accumulateScalar(float *acc, const int16_t *src, int count, float gainStart, float step)
+{
+    for (int i = 0; i < count; ++i) {
+        acc[i] += (float)src[i] * (gainStart + step * i);
+    }
+}
+
+void packScalar(int16_t *dst, const float *acc, int count)
+{
+    for (int i = 0; i < count; ++i) {
+        float value = acc[i];
+        if (value > 32767.0f) {
+            value = 32767.0f;
+        } else if (value < -32768.0f) {
+            value = -32768.0f;
+        }
+        dst[i] = (int16_t)lrintf(value);
+    }
+}
+
+#ifdef AUDIO_MIXER_X86
+
+__attribute__((target("sse2")))
+void accumulateSse2(float *acc, const int16_t *src, int count, float gainStart, float step)
+{
+    const __m128 ramp = _mm_set_ps(3.0f * step, 2.0f * step, step, 0.0f);
+    const __m128 step4 = _mm_set1_ps(4.0f * step);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        __m128i samples = _mm_loadu_si128((const __m128i*)(src + i));
+        // 符号扩展为 int32：先把每个样本复制到高16位，再算术右移
+        __m128i lo = _mm_srai_epi32(_mm_unpacklo_epi16(samples, samples), 16);
+        __m128i hi = _mm_srai_epi32(_mm_unpackhi_epi16(samples, samples), 16);
+        // 每次由起始增益重新计算，避免逐段累加带来的误差
+        __m128 gainLo = _mm_add_ps(_mm_set1_ps(gainStart + step * i), ramp);
+        __m128 gainHi = _mm_add_ps(gainLo, step4);
+        _mm_storeu_ps(acc + i, _mm_add_ps(_mm_loadu_ps(acc + i), _mm_mul_ps(_mm_cvtepi32_ps(lo), gainLo)));
+        _mm_storeu_ps(acc + i + 4, _mm_add_ps(_mm_loadu_ps(acc + i + 4), _mm_mul_ps(_mm_cvtepi32_ps(hi), gainHi)));
+    }
+    accumulateScalar(acc + i, src + i, count - i, gainStart + step * i, step);
+}
+
+__attribute__((target("sse2")))
+void packSse2(int16_t *dst, const float *acc, int count)
+{
+    const __m128 maxValue = _mm_set1_ps(32767.0f);
+    const __m128 minValue = _mm_set1_ps(-32768.0f);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        // 先在 float 域截断，避免超出 int32 范围的值转换成 0x80000000
+        __m128 a = _mm_max_ps(_mm_min_ps(_mm_loadu_ps(acc + i), maxValue), minValue);
+        __m128 b = _mm_max_ps(_mm_min_ps(_mm_loadu_ps(acc + i + 4), maxValue), minValue);
+        __m128i packed = _mm_packs_epi32(_mm_cvtps_epi32(a), _mm_cvtps_epi32(b));
+        _mm_storeu_si128((__m128i*)(dst + i), packed);
+    }
+    packScalar(dst + i, acc + i, count - i);
+}
+
+__attribute__((target("avx2")))
+void accumulateAvx2(float *acc, const int16_t *src, int count, float gainStart, float step)
+{
+    const __m256 ramp = _mm256_set_ps(7.0f * step, 6.0f * step, 5.0f * step, 4.0f * step,
+                                      3.0f * step, 2.0f * step, step, 0.0f);
+    const __m256 step8 = _mm256_set1_ps(8.0f * step);
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i lo = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(src + i)));
+        __m256i hi = _mm256_cvtepi16_epi32(_mm_loadu_si128((const __m128i*)(src + i + 8)));
+        __m256 gainLo = _mm256_add_ps(_mm256_set1_ps(gainStart + step * i), ramp);
+        __m256 gainHi = _mm256_add_ps(gainLo, step8);
+        _mm256_storeu_ps(acc + i, _mm256_add_ps(_mm256_loadu_ps(acc + i), _mm256_mul_ps(_mm256_cvtepi32_ps(lo), gainLo)));
+        _mm256_storeu_ps(acc + i + 8, _mm256_add_ps(_mm256_loadu_ps(acc + i + 8), _mm256_mul_ps(_mm256_cvtepi32_ps(hi), gainHi)));
+    }
+    accumulateSse2(acc + i, src + i, count - i, gainStart + step * i, step);
+}
+
+__attribute__((target("avx2")))
+void packAvx2(int16_t *dst, const float *acc, int count)
+{
+    const __m256 maxValue = _mm256_set1_ps(32767.0f);
+    const __m256 minValue = _mm256_set1_ps(-32768.0f);
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256 a = _mm256_max_ps(_mm256_min_ps(_mm256_loadu_ps(acc + i), maxValue), minValue);
+        __m256 b = _mm256_max_ps(_mm256_min_ps(_mm256_loadu_ps(acc + i + 8), maxValue), minValue);
+        // packs 在每个128位通道内交错，需要重新排列64位块恢复顺序
+        __m256i packed = _mm256_packs_epi32(_mm256_cvtps_epi32(a), _mm256_cvtps_epi32(b));
+        packed = _mm256_permute4x64_epi64(packed, 0xD8);
+        _mm256_storeu_si256((__m256i*)(dst + i), packed);
+    }
+    packSse2(dst + i, acc + i, count - i);
+}
+
+#endif // AUDIO_MIXER_X86
+
+MixerKernels selectKernels()
+{
+#ifdef AUDIO_MIXER_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return MixerKernels{accumulateAvx2, packAvx2, "avx2"};
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return MixerKernels{accumulateSse2, packSse2, "sse2"};
+    }
+#endif
+    return MixerKernels{accumulateScalar, packScalar, "scalar"};
+}
+
+MixerKernels &kernels()
+{
+    static MixerKernels selected = selectKernels();
+    return selected;
+}
+
+} // namespace
+
+void AudioMixer::clear(float *acc, int count)
+{
+    memset(acc, 0, sizeof(float) * count);
+}
+
+void AudioMixer::accumulate(float *acc, const int16_t *src, int count, float gainStart, float gainEnd)
+{
+    if (count <= 0) {
+        return;
+    }
+    float step = (gainEnd - gainStart) / count;
+    kernels().accumulate(acc, src, count, gainStart, step);
+}
+
+void AudioMixer::pack(int16_t *dst, const float *acc, int count)
+{
+    if (count <= 0) {
+        return;
+    }
+    kernels().pack(dst, acc, count);
+}
+
+const char *AudioMixer::kernelName()
+{
+    return kernels().name;
+}
+
+bool AudioMixer::setKernel(const char *name)
+{
+    if (strcmp(name, "scalar") == 0) {
+        kernels() = MixerKernels{accumulateScalar, packScalar, "scalar"};
+        return true;
+    }
+#ifdef AUDIO_MIXER_X86
+    __builtin_cpu_init();
+    if (strcmp(name, "sse2") == 0 && __builtin_cpu_supports("sse2")) {
+        kernels() = MixerKernels{accumulateSse2, packSse2, "sse2"};
+        return true;
+    }
+    if (strcmp(name, "avx2") == 0 && __builtin_cpu_supports("avx2")) {
+        kernels() = MixerKernels{accumulateAvx2, packAvx2, "avx2"};
+        return true;
+    }
+#endif
+    return false;
+}
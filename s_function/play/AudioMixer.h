@@ -0,0 +1,48 @@
+#ifndef AUDIOMIXER_H
+#define AUDIOMIXER_H
+
+#include <cstdint>
+
+/**
+ * @brief 16位 PCM 混音内核
+ *
+ * 混音分两步：各路数据按增益累加到 float 累加缓冲区，全部累加完成后
+ * 一次性饱和打包回 int16_t。累加过程不会溢出，也不需要事先除以路数。
+ *
+ * 内核在第一次使用时按 CPU 能力选择：AVX2 > SSE2 > 标量，
+ * 非 x86 平台或非 GCC/Clang 编译器只使用标量实现。
+ */
+class AudioMixer
+{
+public:
+    /**
+     * @brief 累加缓冲区清零
+     */
+    static void clear(float *acc, int count);
+
+    /**
+     * @brief 按增益把一路数据累加到累加缓冲区
+     * @param gainStart 第一个样本使用的增益
+     * @param gainEnd 最后一个样本之后的增益，与 gainStart 不同时在本段内线性渐变，避免音量突变产生爆音
+     */
+    static void accumulate(float *acc, const int16_t *src, int count, float gainStart, float gainEnd);
+
+    /**
+     * @brief 把累加结果饱和打包为 int16_t（四舍五入，超出范围的值截断到 [-32768, 32767]）
+     */
+    static void pack(int16_t *dst, const float *acc, int count);
+
+    /**
+     * @brief 当前使用的内核名称（"avx2"、"sse2" 或 "scalar"）
+     */
+    static const char *kernelName();
+
+    /**
+     * @brief 强制使用指定内核（"avx2"、"sse2" 或 "scalar"），供基准测试对比各实现
+     * @return false CPU 或编译器不支持该内核，仍使用原来的内核
+     * @note 不能与混音同时调用
+     */
+    static bool setKernel(const char *name);
+};
+
+#endif // AUDIOMIXER_H
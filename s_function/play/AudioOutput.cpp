@@ -1,17 +1,29 @@
 #include "AudioOutput.h"
+#include "AudioMixer.h"
+#include "AudioPullDevice.h"
 #include <QDebug>
 #include <QEventLoop>
 #include <QTimer>
 #include <QDateTime>
+#include <cstring>
 
 AudioOutput::AudioOutput(QObject *parent)
     : QThread(parent)
     , m_audioOutput(nullptr)
     , m_audioOutputDevice(nullptr)
     , m_initialized(false)
-    , m_20msAudioDataSize(0)
+    , m_periodMs(AUDIO_OUTPUT_PERIOD_MS)
+    , m_bufferMs(AUDIO_OUTPUT_BUFFER_MS)
+    , m_periodSize(0)
+    , m_bufferSize(0)
+    , m_bytesPerFrame(sizeof(int16_t))
+    , m_bytesPerSecond(44100 * sizeof(int16_t))
+    , m_streamList(new StreamList)
+    , m_hazardList(nullptr)
+    , m_isStreaming(false)
+    , m_underrunCount(0)
 {
-    
+
 }
 
 AudioOutput *AudioOutput::getInstance()
@@ -23,122 +35,213 @@ AudioOutput *AudioOutput::getInstance()
 AudioOutput::~AudioOutput()
 {
     cleanup();
+    for (StreamList *list : m_retiredLists) {
+        delete list;
+    }
+    m_retiredLists.clear();
+    delete m_streamList.exchange(nullptr);
 }
 
-int AudioOutput::addThreadIdToPlayQueue(qintptr threadId)
+std::shared_ptr<AudioStream> AudioOutput::openStream(size_t bufferSize)
 {
-    QMutexLocker locker(&m_playQueueMutex);
-    qDebug() << "addThreadIdToPlayQueue threadId:" << threadId;
-    int index = -1;
-    for (int i = 0; i < AUDIO_OUTPUT_MAX_QUEUE; i++) {
-        if (m_playQueue[i] == threadId) {
-            qDebug() << "addThreadIdToPlayQueue index:" << i;
-            return i;
-        }
-        else if (m_playQueue[i] == 0) {
-            index = i;
-        }
-    }
-    if (index >= 0) {
-        m_playQueue[index] = threadId;
-    }
-    qDebug() << "addThreadIdToPlayQueue index:" << index;
-    return index;
+    std::shared_ptr<AudioStream> stream = std::make_shared<AudioStream>(bufferSize, m_bytesPerFrame, m_bytesPerSecond);
+
+    QMutexLocker locker(&m_registryMutex);
+    // 复制当前快照并追加新的一路，再整体发布
+    StreamList *list = new StreamList(*m_streamList.load());
+    list->streams.push_back(stream);
+    publishStreamList(list);
+    qDebug() << "openStream, stream count:" << list->streams.size();
+    return stream;
 }
 
-void AudioOutput::removeThreadIdFromPlayQueue(int queueIndex)
+size_t AudioOutput::bytesForDuration(int durationMs) const
 {
-    QMutexLocker locker(&m_playQueueMutex);
-    m_playQueue[queueIndex % AUDIO_OUTPUT_MAX_QUEUE] = 0;
+    size_t bytes = static_cast<size_t>(m_bytesPerSecond) * durationMs / 1000;
+    return bytes - bytes % m_bytesPerFrame;
 }
 
-void AudioOutput::addAudioDataToQueue(int queueIndex, QByteArray audioData)
+void AudioOutput::closeStream(const std::shared_ptr<AudioStream> &stream)
 {
-    // 如果一包大于20ms音频数据大小，则拆分成多个20ms音频数据
-    int maxSize = m_20msAudioDataSize;
-    if (audioData.size() > maxSize) {
-        int offset = 0;
-        int totalSize = audioData.size();
-        
-        // 拆分完整的数据包
-        while (offset + maxSize <= totalSize) {
-            QByteArray packet = audioData.mid(offset, maxSize);
-            m_audioDataQueue[queueIndex].push(packet);
-            offset += maxSize;
-        }
-        
-        // 处理剩余的不完整数据包（如果有）
-        if (offset < totalSize) {
-            QByteArray remainingPacket = audioData.mid(offset);
-            m_audioDataQueue[queueIndex].push(remainingPacket);
+    if (!stream) {
+        return;
+    }
+    stream->m_closed.store(true, std::memory_order_release);
+
+    QMutexLocker locker(&m_registryMutex);
+    StreamList *list = new StreamList;
+    for (const std::shared_ptr<AudioStream> &item : m_streamList.load()->streams) {
+        if (item != stream) {
+            list->streams.push_back(item);
         }
     }
-    else {
-        // 小于等于20ms的数据包直接添加
-        m_audioDataQueue[queueIndex].push(audioData);
+    publishStreamList(list);
+    qDebug() << "closeStream, stream count:" << list->streams.size();
+}
+
+void AudioOutput::publishStreamList(StreamList *list)
+{
+    // 以下原子操作均为 seq_cst，与 acquireStreamList() 中的危险指针协议配合
+    m_retiredLists.push_back(m_streamList.exchange(list));
+
+    // 释放混音线程没有在使用的旧快照，正在使用的留到下次注册/注销时再释放
+    StreamList *hazard = m_hazardList.load();
+    for (auto it = m_retiredLists.begin(); it != m_retiredLists.end();) {
+        if (*it != hazard) {
+            delete *it;
+            it = m_retiredLists.erase(it);
+        } else {
+            ++it;
+        }
     }
 }
 
-// 音频混合，平均算法，不考虑音量，仅限类内使用
-QByteArray AudioOutput::mixAudioData(int queueSize, int minSize)
+AudioOutput::StreamList *AudioOutput::acquireStreamList()
 {
-    QByteArray mixed(minSize, 0);
-    int16_t *dst = (int16_t*)mixed.data();
-    int maxSampleCount = minSize / sizeof(int16_t);
-    for(int i = 0; i < AUDIO_OUTPUT_MAX_QUEUE; ++i){
-        if(!m_waitMixAudioData[i].isEmpty()){
-            const int16_t *src = (const int16_t*)m_waitMixAudioData[i].constData();
-            for(int j = 0; j < maxSampleCount; ++j){
-                dst[j] += (int16_t)(src[j] / queueSize);
-            }
-            m_waitMixAudioData[i].remove(0, minSize);
+    StreamList *list = m_streamList.load();
+    while (true) {
+        m_hazardList.store(list);
+        // 设置危险指针后快照未被替换，说明注册线程一定能看到该危险指针，不会释放它
+        StreamList *current = m_streamList.load();
+        if (current == list) {
+            return list;
         }
+        list = current;
     }
+}
 
-    return mixed;
+void AudioOutput::releaseStreamList()
+{
+    m_hazardList.store(nullptr, std::memory_order_release);
 }
 
-// 音频混合，带音量控制，可供外部调用
-QByteArray AudioOutput::mixAudioDataWithVolume(const QByteArray &data1, float volume1,
-    const QByteArray &data2, float volume2)
+void AudioOutput::setBufferTiming(int periodMs, int bufferMs)
 {
-    int size1 = data1.size();
-    int size2 = data2.size();
-    int maxSize = qMax(size1, size2);
+    if (m_initialized) {
+        qDebug() << "setBufferTiming must be called before initialize";
+        return;
+    }
+    m_periodMs = qMax(periodMs, 1);
+    m_bufferMs = qMax(bufferMs, m_periodMs);
+}
 
-    QByteArray mixed(maxSize, 0);
+// 取出环形缓冲区两段区域中 offset 处的指针，并把 length 限制在该段剩余的连续长度内
+template<typename SpanType>
+static auto spanPointer(const SpanType spans[2], size_t offset, size_t &length) -> decltype(spans[0].data)
+{
+    if (offset < spans[0].size) {
+        length = qMin(length, spans[0].size - offset);
+        return spans[0].data + offset;
+    }
+    offset -= spans[0].size;
+    length = qMin(length, spans[1].size - offset);
+    return spans[1].data + offset;
+}
 
-    const int16_t *src1 = (const int16_t*)data1.constData();
-    const int16_t *src2 = (const int16_t*)data2.constData();
-    int16_t *dst = (int16_t*)mixed.data();
+// 音频混合，按每路音量累加后饱和打包，仅限类内使用
+size_t AudioOutput::mixAudioData(char *output, size_t maxSize)
+{
+    StreamList *list = acquireStreamList();
+
+    // 只混合未暂停且有数据的路，混合长度取各路可读数据的最小值
+    m_mixInputs.clear();
+    size_t mixSize = maxSize;
+    for (const std::shared_ptr<AudioStream> &stream : list->streams) {
+        // 暂停的路也要执行冲刷，跳转后恢复播放时不会先播出旧数据
+        stream->applyFlush();
+        if (stream->isPaused()) {
+            continue;
+        }
+        MixInput input;
+        input.stream = stream.get();
+        size_t available = stream->m_buffer.readSpans(input.spans);
+        if (available == 0) {
+            continue;
+        }
+        m_mixInputs.push_back(input);
+        mixSize = qMin(mixSize, available);
+    }
+    mixSize -= mixSize % m_bytesPerFrame;
+    if (m_mixInputs.empty() || mixSize == 0) {
+        releaseStreamList();
+        return 0;
+    }
 
-    int sampleCount1 = size1 / sizeof(int16_t);
-    int sampleCount2 = size2 / sizeof(int16_t);
-    int maxSampleCount = maxSize / sizeof(int16_t);
+    int sampleCount = mixSize / sizeof(int16_t);
+    if (m_mixBuffer.size() < static_cast<size_t>(sampleCount)) {
+        m_mixBuffer.resize(sampleCount);
+    }
+    float *acc = m_mixBuffer.data();
+    AudioMixer::clear(acc, sampleCount);
+
+    // 刚混音的数据在设备缓冲区排队后才会被听到，以缓冲区时长作为输出延迟
+    qint64 nowUs = AudioStream::currentTimeUs();
+    qint64 latencyUs = static_cast<qint64>(m_bufferMs) * 1000;
+
+    // 各路输入可能在不同位置绕回，按连续区间分段累加，音量在整个混音块内线性过渡
+    for (MixInput &input : m_mixInputs) {
+        AudioStream *stream = input.stream;
+        float gainStart = stream->m_currentGain;
+        float gainEnd = stream->gain();
+        float gainDelta = gainEnd - gainStart;
+        size_t offset = 0;
+        while (offset < mixSize) {
+            size_t length = mixSize - offset;
+            const int16_t *src = (const int16_t*)spanPointer(input.spans, offset, length);
+            float segmentStart = gainStart + gainDelta * offset / mixSize;
+            float segmentEnd = gainStart + gainDelta * (offset + length) / mixSize;
+            AudioMixer::accumulate(acc + offset / sizeof(int16_t), src, length / sizeof(int16_t), segmentStart, segmentEnd);
+            offset += length;
+        }
+        stream->m_currentGain = gainEnd;
+        stream->m_buffer.commitRead(mixSize);
+        stream->onMixed(mixSize, nowUs, latencyUs);
+    }
+    releaseStreamList();
 
-    for (int i = 0; i < maxSampleCount; i++) {
-        float mixedValue = 0.0f;
+    AudioMixer::pack((int16_t*)output, acc, sampleCount);
+    return mixSize;
+}
 
-        // 如果data1还有数据，加上它（应用音量）
-        if (i < sampleCount1) {
-            mixedValue += (float)src1[i] * volume1;
+qint64 AudioOutput::pullAudioData(char *data, qint64 maxSize)
+{
+    qint64 size = maxSize - maxSize % m_bytesPerFrame;
+    qint64 filled = 0;
+    // 按混音周期分块混合，某一路数据用完后下一块只混合剩余的路
+    while (filled < size) {
+        size_t mixed = mixAudioData(data + filled, qMin<qint64>(size - filled, m_periodSize));
+        if (mixed == 0) {
+            break;
         }
+        filled += mixed;
+    }
 
-        // 如果data2还有数据，加上它（应用音量）
-        if (i < sampleCount2) {
-            mixedValue += (float)src2[i] * volume2;
+    if (filled < size) {
+        // 正在播放时数据不足，声卡将播放静音
+        if (m_isStreaming) {
+            m_underrunCount.fetch_add(1, std::memory_order_relaxed);
         }
+        memset(data + filled, 0, size - filled);
+    }
+    m_isStreaming = filled == size;
+    // 始终返回请求的数据量，设备保持运行，新数据到达后下一次回调即可播放
+    return size;
+}
 
-        // 限制范围
-        if (mixedValue > 32767.0f){
-            mixedValue = 32767.0f;
-        }
-        if (mixedValue < -32768.0f){
-            mixedValue = -32768.0f;
-        }
+// 音频混合，带音量控制，可供外部调用
+QByteArray AudioOutput::mixAudioDataWithVolume(const QByteArray &data1, float volume1,
+    const QByteArray &data2, float volume2)
+{
+    int sampleCount1 = data1.size() / sizeof(int16_t);
+    int sampleCount2 = data2.size() / sizeof(int16_t);
+    int maxSampleCount = qMax(sampleCount1, sampleCount2);
 
-        dst[i] = (int16_t)mixedValue;
-    }
+    QByteArray mixed(qMax(data1.size(), data2.size()), 0);
+    std::vector<float> acc(maxSampleCount);
+    AudioMixer::clear(acc.data(), maxSampleCount);
+    AudioMixer::accumulate(acc.data(), (const int16_t*)data1.constData(), sampleCount1, volume1, volume1);
+    AudioMixer::accumulate(acc.data(), (const int16_t*)data2.constData(), sampleCount2, volume2, volume2);
+    AudioMixer::pack((int16_t*)mixed.data(), acc.data(), maxSampleCount);
 
     return mixed;
 }
@@ -175,6 +278,12 @@ bool AudioOutput::initialize(int sampleRate, int channelCount, int sampleSize)
                  << ", channels:" << m_audioFormat.channelCount();
     }
 
+    // 混音周期和设备缓冲区字节数（44100Hz, 16bit, 单声道 = 2字节/样本，5ms = 441字节）
+    m_bytesPerFrame = m_audioFormat.sampleSize() / 8 * m_audioFormat.channelCount();
+    m_bytesPerSecond = m_audioFormat.sampleRate() * m_bytesPerFrame;
+    m_periodSize = m_audioFormat.sampleRate() * m_periodMs / 1000 * m_bytesPerFrame;
+    m_bufferSize = m_audioFormat.sampleRate() * m_bufferMs / 1000 * m_bytesPerFrame;
+
     m_initialized = true;
     start();
     return true;
@@ -197,78 +306,46 @@ void AudioOutput::run()
         return;
     }
 
-    // 设置缓冲区大小（44100Hz, 16bit, 单声道 = 2字节/样本，20ms = 44100*0.02*2 = 1764字节）
-    m_20msAudioDataSize = m_audioFormat.sampleRate() * m_audioFormat.sampleSize() / 8 * m_audioFormat.channelCount() / 50; // 20ms缓冲区
-    audioOutput->setBufferSize(m_20msAudioDataSize * 4);
-    qDebug() << "Audio output buffer size set to:" << m_20msAudioDataSize << "bytes";
+    // 设置缓冲区大小，周期大小由后端根据缓冲区大小决定
+    audioOutput->setBufferSize(m_bufferSize);
+    qDebug() << "Audio output buffer size set to:" << m_bufferSize << "bytes, period:" << m_periodSize << "bytes";
 
-    QIODevice *audioOutputDevice = audioOutput->start();
-    if (!audioOutputDevice) {
-        qDebug() << "Failed to start audio output device!";
-        delete audioOutput;
-        return;
-    }
+    // 拉模式：声卡需要数据时回调 readData() 混音，不再由定时器推送
+    AudioPullDevice *pullDevice = new AudioPullDevice(this, nullptr);
+    pullDevice->open(QIODevice::ReadOnly);
+    audioOutput->start(pullDevice);
 
     qDebug() << "Output device:" << m_outputDevice.deviceName();
+    qDebug() << "Audio mixer kernel:" << AudioMixer::kernelName();
     qDebug() << "Initial audio output state:" << audioOutput->state();
 
-    // 使用事件循环方式运行（参考 WhisperASR）
+    // 使用事件循环方式运行（参考 WhisperASR），QAudioOutput 在本线程的事件循环中回调取数据
     QEventLoop loop;
-    QTimer *writeTimer = new QTimer(nullptr);
-    writeTimer->setInterval(20); // 每10ms检查一次是否有数据需要写入
+    QTimer *stopTimer = new QTimer(nullptr);
+    stopTimer->setInterval(AUDIO_OUTPUT_STOP_CHECK_MS);
 
-    // 连接定时器，在定时器触发时写入音频数据
-    QObject::connect(writeTimer, &QTimer::timeout, [this, audioOutput, audioOutputDevice, writeTimer, &loop]() {
+    // 定时检查线程是否被中断
+    QObject::connect(stopTimer, &QTimer::timeout, [this, stopTimer, &loop]() {
         if (isInterruptionRequested()) {
-            writeTimer->stop();
+            stopTimer->stop();
             loop.quit();
-            return;
-        }
-
-        int minSize = AUDIO_MAX_SIZE, queueSize = 0;
-        for(int i = 0; i < AUDIO_OUTPUT_MAX_QUEUE; ++i){
-            if(!m_audioDataQueue[i].empty()){
-                QByteArray temp;
-                while (m_waitMixAudioData[i].size() < m_20msAudioDataSize && !m_audioDataQueue[i].empty()) {
-                    m_audioDataQueue[i].pop(temp);
-                    m_waitMixAudioData[i].append(temp);
-                }
-                minSize = qMin(minSize, m_waitMixAudioData[i].size());
-                queueSize++;
-            }
-        }
-
-        QByteArray audioData1;
-        if(queueSize > 0){
-            audioData1 = mixAudioData(queueSize, minSize);
-        }
-
-        if(audioData1.size() > 0) {
-            m_audioDataList.append(audioData1);
-        }
-        
-        if (!m_audioDataList.isEmpty() && audioOutputDevice) {
-            // 写入20ms音频数据到输出设备
-            QByteArray audioData = m_audioDataList.left(m_20msAudioDataSize);
-            qint64 written = audioOutputDevice->write(audioData);
-            m_audioDataList.remove(0, written);
         }
     });
 
-    writeTimer->start();
+    stopTimer->start();
 
     // 运行事件循环（直到线程被中断或停止播放）
     loop.exec();
 
-    writeTimer->stop();
-    delete writeTimer;
+    stopTimer->stop();
+    delete stopTimer;
 
     qDebug() << "Stopping audio output...";
-    if (audioOutputDevice) {
-        audioOutputDevice->close();
-    }
     audioOutput->stop();
+    pullDevice->close();
     delete audioOutput;
+    delete pullDevice;
+    qDebug() << "Audio output underruns:" << getUnderrunCount();
 }
 
 void AudioOutput::cleanup()
@@ -283,7 +360,5 @@ void AudioOutput::cleanup()
         m_audioOutput = nullptr;
     }
 
-    m_audioDataList.clear();
-
     m_initialized = false;
 }
@@ -9,11 +9,17 @@
 #include <QIODevice>
 #include <QAudioFormat>
 #include <QAudioDeviceInfo>
-#include "../models/SPSCLockFreeQueue.h"
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "AudioStream.h"
 
-#define AUDIO_OUTPUT_MAX_QUEUE 10
-#define AUDIO_OUTPUT_MAX_QUEUE_SIZE 1024 * 8 // 1024个20ms音频数据大小
-#define AUDIO_MAX_SIZE 1024 * 1024 * 512 // 64MB
+#define AUDIO_OUTPUT_STREAM_BUFFER_SIZE (1024 * 1024 * 8) // 默认每路音频缓冲区大小（44100Hz单声道16位约95秒），用于整段写入的音频
+#define AUDIO_OUTPUT_PERIOD_MS 5 // 默认混音周期，单次混音的最大时长，也是音量渐变的长度
+#define AUDIO_OUTPUT_BUFFER_MS 10 // 默认设备缓冲区时长，决定输出延迟
+#define AUDIO_OUTPUT_STOP_CHECK_MS 100 // 检查线程是否需要退出的间隔
+
+class AudioPullDevice;
 
 class AudioOutput : public QThread
 {
@@ -25,17 +31,23 @@ public:
 
     static AudioOutput *getInstance();
 
+    // 设置混音周期和设备缓冲区时长（毫秒），需在 initialize() 之前调用
+    void setBufferTiming(int periodMs, int bufferMs);
+
     // 初始化音频输出格式
     bool initialize(int sampleRate = 44100, int channelCount = 1, int sampleSize = 16);
 
-    // 添加threadId到播放队列，返回队列索引
-    int addThreadIdToPlayQueue(qintptr threadId);
+    // 打开一路音频（线程安全），路数只受内存限制
+    std::shared_ptr<AudioStream> openStream(size_t bufferSize = AUDIO_OUTPUT_STREAM_BUFFER_SIZE);
 
-    // 移除对列索引对应的threadId
-    void removeThreadIdFromPlayQueue(int queueIndex);
+    // 按输出格式把时长换算为字节数（整帧），边解码边写入的音频据此确定缓冲区大小
+    size_t bytesForDuration(int durationMs) const;
 
-    // 添加音频数据到队列
-    void addAudioDataToQueue(int threadId, QByteArray audioData);
+    // 关闭一路音频（线程安全），该路立即停止混音，未播放的数据被丢弃
+    void closeStream(const std::shared_ptr<AudioStream> &stream);
+
+    // 设备取数据时混音数据不足的次数（包括一段音频正常播放结束）
+    quint64 getUnderrunCount() const { return m_underrunCount.load(std::memory_order_relaxed); }
 
     // 带音量控制的混合（音量范围0.0-1.0）
     QByteArray mixAudioDataWithVolume(const QByteArray &data1, float volume1,
@@ -45,11 +57,28 @@ signals:
     void playbackFinished();
 
 private:
+    friend class AudioPullDevice;
+
     void run() override;
     void cleanup();
 
-    // 音频混合，平均算法，不考虑音量，仅限类内使用
-    QByteArray mixAudioData(int queueSize, int minSize);
+    // 由 AudioPullDevice::readData() 在音频线程中调用，混音填满设备请求的数据，不足部分补静音
+    qint64 pullAudioData(char *data, qint64 maxSize);
+
+    // 音频混合，仅限类内使用
+    // 直接在各路缓冲区上按音量累加，饱和打包后写入 output，返回混合的字节数
+    size_t mixAudioData(char *output, size_t maxSize);
+
+    // 已注册音频的快照，发布后不再修改，注册/注销时整体替换
+    struct StreamList {
+        std::vector<std::shared_ptr<AudioStream>> streams;
+    };
+
+    // 混音线程获取当前快照，并用危险指针保护它不被释放
+    StreamList *acquireStreamList();
+    void releaseStreamList();
+    // 发布新快照，旧快照在混音线程不再使用后释放（调用时需持有 m_registryMutex）
+    void publishStreamList(StreamList *list);
     
     // 音频格式
     QAudioFormat m_audioFormat;
@@ -57,20 +86,38 @@ private:
     QIODevice *m_audioOutputDevice;
     QAudioDeviceInfo m_outputDevice;
     
-    // 音频数据队列
-    QByteArray m_audioDataList;
-    // 等待混音对列
-    QByteArray m_waitMixAudioData[AUDIO_OUTPUT_MAX_QUEUE];
     bool m_initialized;
 
-    // 20ms音频数据大小
-    int m_20msAudioDataSize;
-    // 音频数据队列数组
-    SPSCLockFreeQueue<QByteArray, AUDIO_OUTPUT_MAX_QUEUE_SIZE> m_audioDataQueue[AUDIO_OUTPUT_MAX_QUEUE];
-    // 播放队列（使用 qintptr 可以安全存储线程 ID，无论是 int 还是指针）
-    qintptr m_playQueue[AUDIO_OUTPUT_MAX_QUEUE];
-    // 播放队列互斥锁
-    QMutex m_playQueueMutex;
+    // 混音周期和设备缓冲区时长（毫秒）
+    int m_periodMs;
+    int m_bufferMs;
+    // 混音周期和设备缓冲区对应的字节数
+    int m_periodSize;
+    int m_bufferSize;
+    // 一帧（所有声道一个采样点）的字节数
+    int m_bytesPerFrame;
+    // 每秒音频的字节数，用于字节数和时长的换算
+    int m_bytesPerSecond;
+    // 当前已注册音频的快照，混音线程只读，不加锁
+    std::atomic<StreamList*> m_streamList;
+    // 混音线程正在使用的快照（危险指针），注册线程不会释放它
+    std::atomic<StreamList*> m_hazardList;
+    // 已被替换、等待释放的旧快照（由 m_registryMutex 保护）
+    std::vector<StreamList*> m_retiredLists;
+    // 只用于串行化注册/注销操作，混音线程从不获取
+    QMutex m_registryMutex;
+
+    // 参与本次混音的一路输入（仅混音线程使用）
+    struct MixInput {
+        AudioStream *stream;
+        PcmRingBuffer::ConstSpan spans[2];
+    };
+    std::vector<MixInput> m_mixInputs;
+    // 混音累加缓冲区（仅混音线程使用）
+    std::vector<float> m_mixBuffer;
+    // 上一次设备取数据时是否有音频在播放，用于统计欠载
+    bool m_isStreaming;
+    std::atomic<quint64> m_underrunCount;
 };
 
 #endif // AUDIOOUTPUT_H
@@ -0,0 +1,22 @@
+#include "AudioPullDevice.h"
+#include "AudioOutput.h"
+
+AudioPullDevice::AudioPullDevice(AudioOutput *output, QObject *parent)
+    : QIODevice(parent)
+    , m_output(output)
+{
+
+}
+
+qint64 AudioPullDevice::readData(char *data, qint64 maxSize)
+{
+    return m_output->pullAudioData(data, maxSize);
+}
+
+qint64 AudioPullDevice::writeData(const char *data, qint64 maxSize)
+{
+    Q_UNUSED(data);
+    Q_UNUSED(maxSize);
+    // 只读设备
+    return -1;
+}
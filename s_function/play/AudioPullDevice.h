@@ -0,0 +1,32 @@
+#ifndef AUDIOPULLDEVICE_H
+#define AUDIOPULLDEVICE_H
+
+#include <QIODevice>
+
+class AudioOutput;
+
+/**
+ * @brief 拉模式音频设备
+ *
+ * 交给 QAudioOutput::start(QIODevice*) 使用，声卡需要数据时由 QAudioOutput
+ * 调用 readData()，在回调中直接从各路 PCM 缓冲区混音写入设备缓冲区。
+ * 数据量由设备决定，不再依赖定时器的触发精度。
+ */
+class AudioPullDevice : public QIODevice
+{
+    Q_OBJECT
+
+public:
+    explicit AudioPullDevice(AudioOutput *output, QObject *parent = nullptr);
+
+    bool isSequential() const override { return true; }
+
+protected:
+    qint64 readData(char *data, qint64 maxSize) override;
+    qint64 writeData(const char *data, qint64 maxSize) override;
+
+private:
+    AudioOutput *m_output;
+};
+
+#endif // AUDIOPULLDEVICE_H
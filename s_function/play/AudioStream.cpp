@@ -0,0 +1,189 @@
+#include "AudioStream.h"
+#include <QDebug>
+#include <chrono>
+
+qint64 AudioStream::currentTimeUs()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+AudioStream::AudioStream(size_t bufferSize, int bytesPerFrame, int bytesPerSecond)
+    : m_buffer(bufferSize)
+    , m_bytesPerFrame(bytesPerFrame)
+    , m_bytesPerSecond(bytesPerSecond)
+    , m_gain(1.0f)
+    , m_paused(false)
+    , m_closed(false)
+    , m_currentGain(1.0f)
+    , m_writtenBytes(0)
+    , m_consumedBytes(0)
+    , m_baseMarker{0, 0, 1.0}
+    , m_hasBaseMarker(false)
+    , m_flushOffset(0)
+    , m_flushGeneration(0)
+    , m_appliedGeneration(0)
+    , m_clockSeq(0)
+    , m_clockPtsUs(0)
+    , m_clockTimeUs(0)
+    , m_clockLatencyUs(0)
+    , m_clockRate(1.0)
+    , m_clockGeneration(0)
+{
+
+}
+
+size_t AudioStream::write(const char *data, size_t size)
+{
+    if (isClosed()) {
+        return 0;
+    }
+    // 直接拷贝进环形缓冲区，这是数据唯一的一次拷贝
+    size_t written = m_buffer.write(data, size, m_bytesPerFrame);
+    if (written < size) {
+        qDebug() << "Audio stream buffer full, dropped" << size - written << "bytes";
+    }
+    m_writtenBytes += written;
+    return written;
+}
+
+size_t AudioStream::write(const QByteArray &data)
+{
+    return write(data.constData(), data.size());
+}
+
+size_t AudioStream::write(const QByteArray &data, qint64 ptsMs, double rate)
+{
+    if (isClosed()) {
+        return 0;
+    }
+    // 标记队列满时沿用上一个标记继续推算，只损失一点精度
+    m_markers.push(PtsMarker{m_writtenBytes, ptsMs * 1000, rate});
+    return write(data.constData(), data.size());
+}
+
+void AudioStream::flush()
+{
+    m_flushOffset.store(m_writtenBytes, std::memory_order_release);
+    m_flushGeneration.fetch_add(1, std::memory_order_release);
+}
+
+void AudioStream::applyFlush()
+{
+    quint32 generation = m_flushGeneration.load(std::memory_order_acquire);
+    if (generation == m_appliedGeneration.load(std::memory_order_relaxed)) {
+        return;
+    }
+    // 冲刷位置之前的数据已经提交到缓冲区，直接跳过；连续多次冲刷时可能读到更新的位置，同样已提交
+    quint64 offset = m_flushOffset.load(std::memory_order_acquire);
+    if (offset > m_consumedBytes) {
+        m_buffer.commitRead(static_cast<size_t>(offset - m_consumedBytes));
+        m_consumedBytes = offset;
+    }
+    // 丢弃旧数据的标记，新数据的标记从冲刷位置开始，播放到时重新建立时钟
+    PtsMarker stale;
+    PtsMarker *marker = m_markers.peek();
+    while (marker && marker->offset < offset) {
+        m_markers.pop(stale);
+        marker = m_markers.peek();
+    }
+    // 冲刷请求晚于读取时已经混音了一部分新数据，此时当前标记属于新数据，保留
+    if (m_hasBaseMarker && m_baseMarker.offset < offset) {
+        m_hasBaseMarker = false;
+    }
+    m_appliedGeneration.store(generation, std::memory_order_release);
+}
+
+void AudioStream::onMixed(size_t bytes, qint64 nowUs, qint64 latencyUs)
+{
+    m_consumedBytes += bytes;
+    // 取出已经开始播放的标记，最后一个即为当前生效的标记
+    PtsMarker *marker = m_markers.peek();
+    while (marker && marker->offset <= m_consumedBytes) {
+        m_markers.pop(m_baseMarker);
+        m_hasBaseMarker = true;
+        marker = m_markers.peek();
+    }
+    if (!m_hasBaseMarker || m_bytesPerSecond <= 0) {
+        return;
+    }
+
+    qint64 mixedUs = (qint64)((m_consumedBytes - m_baseMarker.offset) * 1000000 / m_bytesPerSecond);
+    qint64 ptsUs = m_baseMarker.ptsUs + (qint64)(mixedUs * m_baseMarker.rate);
+
+    // 顺序锁写入：序号为奇数时读取线程会重试
+    quint32 seq = m_clockSeq.load(std::memory_order_relaxed);
+    m_clockSeq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_clockPtsUs.store(ptsUs, std::memory_order_relaxed);
+    m_clockTimeUs.store(nowUs, std::memory_order_relaxed);
+    m_clockLatencyUs.store(latencyUs, std::memory_order_relaxed);
+    m_clockRate.store(m_baseMarker.rate, std::memory_order_relaxed);
+    m_clockGeneration.store(m_appliedGeneration.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    m_clockSeq.store(seq + 2, std::memory_order_release);
+}
+
+bool AudioStream::playbackPosition(qint64 &ptsMs) const
+{
+    qint64 ptsUs, timeUs, latencyUs;
+    double rate;
+    quint32 generation;
+    quint32 seq;
+    while (true) {
+        seq = m_clockSeq.load(std::memory_order_acquire);
+        if (seq & 1) {
+            continue;
+        }
+        ptsUs = m_clockPtsUs.load(std::memory_order_relaxed);
+        timeUs = m_clockTimeUs.load(std::memory_order_relaxed);
+        latencyUs = m_clockLatencyUs.load(std::memory_order_relaxed);
+        rate = m_clockRate.load(std::memory_order_relaxed);
+        generation = m_clockGeneration.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (m_clockSeq.load(std::memory_order_relaxed) == seq) {
+            break;
+        }
+    }
+    // 冲刷之后，新数据开始播放前的时钟属于旧数据
+    if (seq == 0 || generation != m_flushGeneration.load(std::memory_order_acquire)) {
+        return false;
+    }
+
+    // 刚混音完成的数据要经过输出延迟才会被听到；此后设备没有再取数据，时钟最多推进到该位置
+    qint64 elapsedUs = currentTimeUs() - timeUs;
+    if (elapsedUs < 0) {
+        elapsedUs = 0;
+    } else if (elapsedUs > latencyUs) {
+        elapsedUs = latencyUs;
+    }
+    ptsMs = (ptsUs - (qint64)((latencyUs - elapsedUs) * rate)) / 1000;
+    return true;
+}
+
+size_t AudioStream::bufferedBytes() const
+{
+    // 冲刷尚未被混音线程执行时，只有冲刷之后写入的数据会被播放
+    quint32 generation = m_flushGeneration.load(std::memory_order_acquire);
+    if (generation != m_appliedGeneration.load(std::memory_order_acquire)) {
+        return static_cast<size_t>(m_writtenBytes - m_flushOffset.load(std::memory_order_relaxed));
+    }
+    return m_buffer.readableBytes();
+}
+
+qint64 AudioStream::bufferedDurationMs() const
+{
+    if (m_bytesPerSecond <= 0) {
+        return 0;
+    }
+    return (qint64)bufferedBytes() * 1000 / m_bytesPerSecond;
+}
+
+void AudioStream::setPaused(bool paused)
+{
+    m_paused.store(paused, std::memory_order_relaxed);
+}
+
+void AudioStream::setGain(float gain)
+{
+    m_gain.store(gain > 0.0f ? gain : 0.0f, std::memory_order_relaxed);
+}
@@ -0,0 +1,131 @@
+#ifndef AUDIOSTREAM_H
+#define AUDIOSTREAM_H
+
+#include <QByteArray>
+#include <atomic>
+#include "PcmRingBuffer.h"
+#include "../models/SPSCRingQueue.h"
+
+#define AUDIO_STREAM_MAX_MARKERS 256 // 尚未播放的时间戳标记最大个数
+
+class AudioOutput;
+
+/**
+ * @brief 一路输出音频
+ *
+ * 由 AudioOutput::openStream() 创建，生产者持有返回的 shared_ptr 写入 PCM 数据，
+ * 混音线程从内部的环形缓冲区读取。一个线程可以同时持有多路音频。
+ *
+ * 播放时钟：写入数据时可附带该段数据的 PTS，混音线程按已消费的字节数推算
+ * 刚混音完成的 PTS，再减去设备输出延迟，得到此刻扬声器正在播放的 PTS。
+ * 设备停止取数据时时钟随之停止，不会跑到尚未播放的数据之前。
+ *
+ * 注意事项：
+ * - 每路只能有一个生产者线程调用 write()/flush()
+ * - setPaused()/setGain() 可在任意线程调用
+ * - 调用 AudioOutput::closeStream() 后不再参与混音，未播放的数据随对象一起释放
+ */
+class AudioStream
+{
+public:
+    AudioStream(size_t bufferSize, int bytesPerFrame, int bytesPerSecond);
+
+    /**
+     * @brief 写入 PCM 数据
+     * @return 实际写入的字节数，缓冲区不足时只写入能放下的整帧
+     */
+    size_t write(const char *data, size_t size);
+    size_t write(const QByteArray &data);
+
+    /**
+     * @brief 写入带时间戳的 PCM 数据
+     * @param ptsMs 该段数据第一个样本的 PTS（毫秒）
+     * @param rate 每秒 PCM 对应的媒体时长（倍速播放时为倍速值）
+     */
+    size_t write(const QByteArray &data, qint64 ptsMs, double rate = 1.0);
+
+    /**
+     * @brief 此刻扬声器正在播放的 PTS（任意线程可调用）
+     * @return false 表示还没有带时间戳的数据被播放
+     */
+    bool playbackPosition(qint64 &ptsMs) const;
+
+    /**
+     * @brief 丢弃此前写入、尚未混音的全部数据（仅由生产者线程调用）
+     *
+     * 只记录冲刷位置，由混音线程在下次混音时丢弃，之后写入的数据不受影响；
+     * 新数据开始播放之前 playbackPosition() 返回 false，播放时钟随之重新建立。
+     */
+    void flush();
+
+    // 已写入但尚未混音的数据时长（毫秒），不含等待冲刷的数据（仅由生产者线程调用）
+    qint64 bufferedDurationMs() const;
+
+    // 播放时钟使用的单调时间（微秒）
+    static qint64 currentTimeUs();
+
+    // 暂停后混音时跳过该路，缓冲区中的数据保留
+    void setPaused(bool paused);
+    bool isPaused() const { return m_paused.load(std::memory_order_relaxed); }
+
+    // 设置音量（0.0 为静音，1.0 为原始音量），混音时平滑过渡
+    void setGain(float gain);
+    float gain() const { return m_gain.load(std::memory_order_relaxed); }
+
+    bool isClosed() const { return m_closed.load(std::memory_order_acquire); }
+
+    // 已写入但尚未混音的字节数，不含等待冲刷的数据（仅由生产者线程调用）
+    size_t bufferedBytes() const;
+    // 缓冲区剩余可写的字节数，混音线程取走数据后增加（仅由生产者线程调用）
+    size_t writableBytes() const { return m_buffer.writableBytes(); }
+
+private:
+    friend class AudioOutput;
+
+    // 时间戳标记：从第 offset 个字节开始的数据对应 ptsUs
+    struct PtsMarker {
+        quint64 offset;
+        qint64 ptsUs;
+        double rate;
+    };
+
+    // 混音线程读取数据前调用，执行生产者请求的冲刷
+    void applyFlush();
+
+    // 混音线程消费 bytes 字节后调用，更新播放时钟
+    void onMixed(size_t bytes, qint64 nowUs, qint64 latencyUs);
+
+    PcmRingBuffer m_buffer;
+    int m_bytesPerFrame;
+    int m_bytesPerSecond;
+    std::atomic<float> m_gain;
+    std::atomic<bool> m_paused;
+    std::atomic<bool> m_closed;
+    // 混音线程当前使用的音量，只由混音线程访问
+    float m_currentGain;
+
+    // 生产者写入的标记，混音线程按消费进度取出
+    SPSCRingQueue<PtsMarker, AUDIO_STREAM_MAX_MARKERS> m_markers;
+    // 生产者累计写入的字节数（只由生产者访问）
+    quint64 m_writtenBytes;
+    // 混音线程累计消费的字节数和当前生效的标记（只由混音线程访问）
+    quint64 m_consumedBytes;
+    PtsMarker m_baseMarker;
+    bool m_hasBaseMarker;
+
+    // 冲刷请求：生产者先记录冲刷时的写入位置再递增代数，混音线程发现代数变化后丢弃该位置之前的数据
+    std::atomic<quint64> m_flushOffset;
+    std::atomic<quint32> m_flushGeneration;
+    // 混音线程已执行的冲刷代数
+    std::atomic<quint32> m_appliedGeneration;
+
+    // 发布给读取线程的时钟（顺序锁保护）：刚混音完成的 PTS、混音时刻、输出延迟、倍速和冲刷代数
+    std::atomic<quint32> m_clockSeq;
+    std::atomic<qint64> m_clockPtsUs;
+    std::atomic<qint64> m_clockTimeUs;
+    std::atomic<qint64> m_clockLatencyUs;
+    std::atomic<double> m_clockRate;
+    std::atomic<quint32> m_clockGeneration;
+};
+
+#endif // AUDIOSTREAM_H
@@ -0,0 +1,131 @@
+#include "PcmRingBuffer.h"
+#include <cstring>
+
+static size_t roundUpPowerOfTwo(size_t value)
+{
+    size_t result = 64;
+    while (result < value) {
+        result <<= 1;
+    }
+    return result;
+}
+
+PcmRingBuffer::PcmRingBuffer(size_t capacity)
+    : m_capacity(roundUpPowerOfTwo(capacity))
+    , m_mask(m_capacity - 1)
+    , m_buffer(new char[m_capacity])
+{
+
+}
+
+PcmRingBuffer::~PcmRingBuffer()
+{
+    delete[] m_buffer;
+}
+
+size_t PcmRingBuffer::writeSpans(Span spans[2])
+{
+    size_t tail = m_tail.load(std::memory_order_relaxed);
+    // 每次操作搬运的是成百上千字节，每次读取一次对端索引的开销可以忽略
+    size_t freeBytes = m_capacity - (tail - m_head.load(std::memory_order_acquire));
+
+    size_t offset = tail & m_mask;
+    size_t first = m_capacity - offset;
+    if (first > freeBytes) {
+        first = freeBytes;
+    }
+    spans[0].data = m_buffer + offset;
+    spans[0].size = first;
+    spans[1].data = m_buffer;
+    spans[1].size = freeBytes - first;
+    return freeBytes;
+}
+
+void PcmRingBuffer::commitWrite(size_t bytes)
+{
+    if (bytes == 0) {
+        return;
+    }
+    // release：消费者看到新的写位置时，数据已经写入完成
+    m_tail.store(m_tail.load(std::memory_order_relaxed) + bytes, std::memory_order_release);
+}
+
+size_t PcmRingBuffer::write(const char *data, size_t size, size_t align)
+{
+    Span spans[2];
+    size_t freeBytes = writeSpans(spans);
+    if (freeBytes < size) {
+        // 空间不足时只写入能放下的整帧
+        size = align > 1 ? freeBytes - freeBytes % align : freeBytes;
+    }
+
+    size_t first = size < spans[0].size ? size : spans[0].size;
+    memcpy(spans[0].data, data, first);
+    if (size > first) {
+        memcpy(spans[1].data, data + first, size - first);
+    }
+    commitWrite(size);
+    return size;
+}
+
+size_t PcmRingBuffer::readSpans(ConstSpan spans[2])
+{
+    size_t head = m_head.load(std::memory_order_relaxed);
+    size_t available = m_tail.load(std::memory_order_acquire) - head;
+
+    size_t offset = head & m_mask;
+    size_t first = m_capacity - offset;
+    if (first > available) {
+        first = available;
+    }
+    spans[0].data = m_buffer + offset;
+    spans[0].size = first;
+    spans[1].data = m_buffer;
+    spans[1].size = available - first;
+    return available;
+}
+
+void PcmRingBuffer::commitRead(size_t bytes)
+{
+    if (bytes == 0) {
+        return;
+    }
+    // release：生产者看到新的读位置时，数据已经读取完成，空间可以复用
+    m_head.store(m_head.load(std::memory_order_relaxed) + bytes, std::memory_order_release);
+}
+
+size_t PcmRingBuffer::read(char *data, size_t size)
+{
+    ConstSpan spans[2];
+    size_t available = readSpans(spans);
+    if (available < size) {
+        size = available;
+    }
+
+    size_t first = size < spans[0].size ? size : spans[0].size;
+    memcpy(data, spans[0].data, first);
+    if (size > first) {
+        memcpy(data + first, spans[1].data, size - first);
+    }
+    commitRead(size);
+    return size;
+}
+
+size_t PcmRingBuffer::readableBytes() const
+{
+    size_t head = m_head.load(std::memory_order_acquire);
+    size_t tail = m_tail.load(std::memory_order_acquire);
+    // 两次读取之间对端可能推进，只返回合理范围内的值
+    size_t count = tail - head;
+    return count > m_capacity ? m_capacity : count;
+}
+
+size_t PcmRingBuffer::writableBytes() const
+{
+    return m_capacity - readableBytes();
+}
+
+void PcmRingBuffer::clear()
+{
+    m_head.store(m_tail.load(std::memory_order_acquire), std::memory_order_release);
+}
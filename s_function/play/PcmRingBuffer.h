@@ -0,0 +1,104 @@
+#ifndef PCMRINGBUFFER_H
+#define PCMRINGBUFFER_H
+
+#include <atomic>
+#include <cstddef>
+
+/**
+ * @brief 单生产者单消费者无锁 PCM 字节环形缓冲区
+ *
+ * 音频数据以字节流形式连续存放，不再按数据块拆成多个 QByteArray：
+ * - 生产者通过 writeSpans() 取得可写区域（绕回时为两段），直接写入后 commitWrite()
+ * - 消费者通过 readSpans() 取得可读区域（绕回时为两段），原地读取后 commitRead()
+ * 数据从生产者拷贝进缓冲区只发生一次，消费者直接在缓冲区上混音，不再有
+ * mid()/append()/remove() 带来的额外拷贝和内存搬移。
+ *
+ * 注意事项：
+ * - 容量向上取整为2的幂，因此偶数大小的样本不会跨越绕回点
+ * - 只能有一个生产者线程调用 write()/writeSpans()/commitWrite()
+ * - 只能有一个消费者线程调用 read()/readSpans()/commitRead()/clear()
+ */
+class PcmRingBuffer
+{
+public:
+    struct Span {
+        char *data;
+        size_t size;
+    };
+
+    struct ConstSpan {
+        const char *data;
+        size_t size;
+    };
+
+    explicit PcmRingBuffer(size_t capacity);
+    ~PcmRingBuffer();
+
+    PcmRingBuffer(const PcmRingBuffer &) = delete;
+    PcmRingBuffer &operator=(const PcmRingBuffer &) = delete;
+
+    size_t capacity() const { return m_capacity; }
+
+    /**
+     * @brief 获取可写区域（仅由生产者线程调用）
+     * @param spans 输出两段可写区域，第二段在没有绕回时大小为0
+     * @return 可写字节总数
+     */
+    size_t writeSpans(Span spans[2]);
+
+    /**
+     * @brief 提交已写入的字节数（仅由生产者线程调用）
+     */
+    void commitWrite(size_t bytes);
+
+    /**
+     * @brief 拷贝写入（仅由生产者线程调用）
+     * @param align 实际写入字节数向下对齐到该值（通常是一帧的字节数），避免写入半帧
+     * @return 实际写入的字节数，空间不足时小于 size
+     */
+    size_t write(const char *data, size_t size, size_t align = 1);
+
+    /**
+     * @brief 获取可读区域（仅由消费者线程调用）
+     * @param spans 输出两段可读区域，第二段在没有绕回时大小为0
+     * @return 可读字节总数
+     */
+    size_t readSpans(ConstSpan spans[2]);
+
+    /**
+     * @brief 提交已读取的字节数，释放对应空间（仅由消费者线程调用）
+     */
+    void commitRead(size_t bytes);
+
+    /**
+     * @brief 拷贝读取（仅由消费者线程调用）
+     * @return 实际读取的字节数
+     */
+    size_t read(char *data, size_t size);
+
+    /**
+     * @brief 可读字节数（近似值，任意线程可调用）
+     */
+    size_t readableBytes() const;
+
+    /**
+     * @brief 可写字节数（近似值，任意线程可调用）
+     */
+    size_t writableBytes() const;
+
+    /**
+     * @brief 丢弃所有可读数据（仅由消费者线程调用）
+     */
+    void clear();
+
+private:
+    size_t m_capacity;
+    size_t m_mask;
+    char *m_buffer;
+
+    // 读写位置分别独占缓存行，避免伪共享
+    alignas(64) std::atomic<size_t> m_head{0};
+    alignas(64) std::atomic<size_t> m_tail{0};
+};
+
+#endif // PCMRINGBUFFER_H
@@ -3,27 +3,26 @@
 
 #include "VideoFrame.h"
 #include "AudioOutput.h"
-#include <QPainter>
+#include <QQuickWindow>
+#include <QSGSimpleRectNode>
+#include <QSGSimpleTextureNode>
 #include <QDebug>
 
 VideoFrame::VideoFrame(QQuickItem *parent)
-    : QQuickPaintedItem(parent)
+    : QQuickItem(parent)
+    , m_imageDirty(false)
+    , m_droppedFrames(0)
 {
-    setAntialiasing(true);
+    setFlag(ItemHasContents, true);
     m_videoRender = new VideoRender(this);
-    // 使用Qt::QueuedConnection确保跨线程安全
-    connect(m_videoRender, &VideoRender::videoFrameReady, this, &VideoFrame::setCurrentImage, Qt::QueuedConnection);
+    // 新帧只通过信箱传递，信号仅用于请求下一次同步；取帧之前不会重复发出，事件不会堆积
+    connect(m_videoRender, &VideoRender::frameAvailable, this, &QQuickItem::update, Qt::QueuedConnection);
 }
 
 VideoFrame::~VideoFrame()
 {
     if (m_videoRender) {
-        // 先停止播放
-        m_videoRender->setPlaying(false);
-        // 等待线程结束
-        if (m_videoRender->isRunning()) {
-            m_videoRender->wait();
-        }
+        // 析构时停止渲染线程和所有工作线程
         delete m_videoRender;
         m_videoRender = nullptr;
     }
@@ -54,6 +53,16 @@ void VideoFrame::seekTo(int seconds)
     m_videoRender->seekTo(seconds);
 }
 
+void VideoFrame::seekToMs(qint64 positionMs)
+{
+    m_videoRender->seekToMs(positionMs);
+}
+
+qint64 VideoFrame::getSeekLatencyMs() const
+{
+    return m_videoRender->getSeekLatencyMs();
+}
+
 void VideoFrame::setPlaySpeed(float speed)
 {
     m_videoRender->setPlaySpeed(speed);
@@ -66,14 +75,8 @@ bool VideoFrame::openVideo(const QString &filePath)
 
 void VideoFrame::setPlaying(bool isPlaying)
 {
-    if(isPlaying)
-    {
-        m_videoRender->start();
-    }
-    else
-    {
-        m_videoRender->setPlaying(false);
-    }
+    // 线程在 openVideo() 时已启动，这里只切换播放器状态，线程挂起/唤醒而不重建
+    m_videoRender->setPlaying(isPlaying);
 }
 
 void VideoFrame::closeVideo()
@@ -81,14 +84,89 @@ void VideoFrame::closeVideo()
     m_videoRender->closeVideo();
 }
 
-void VideoFrame::paint(QPainter *painter)
+QSGNode *VideoFrame::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data)
 {
+    Q_UNUSED(data);
+
+    // 在渲染线程调用，此时 GUI 线程被阻塞，可以安全读写 m_currentImage
+    QImage latest;
+    quint64 dropped = 0;
+    if (m_videoRender->takeLatestFrame(latest, dropped)) {
+        m_currentImage = latest;
+        m_imageDirty = true;
+        if (dropped > 0) {
+            m_droppedFrames.fetch_add(dropped);
+        }
+        // 渲染线程发出，自动以队列方式送达 GUI 线程的接收者
+        emit currentImageChanged();
+    }
+
     if (m_currentImage.isNull()) {
-        painter->fillRect(boundingRect(), Qt::black);
-        return;
+        QSGSimpleRectNode *rectNode = dynamic_cast<QSGSimpleRectNode *>(oldNode);
+        if (!rectNode) {
+            delete oldNode;
+            rectNode = new QSGSimpleRectNode(boundingRect(), Qt::black);
+        }
+        rectNode->setRect(boundingRect());
+        return rectNode;
     }
 
-    painter->drawImage(boundingRect(), m_currentImage);
+    QSGSimpleTextureNode *textureNode = dynamic_cast<QSGSimpleTextureNode *>(oldNode);
+    if (!textureNode) {
+        delete oldNode;
+        textureNode = new QSGSimpleTextureNode();
+        textureNode->setOwnsTexture(true);
+        textureNode->setFiltering(QSGTexture::Linear);
+        m_imageDirty = true;
+    }
+
+    if (m_imageDirty) {
+        // 每个新帧只上传一次，旧纹理由节点释放
+        QSGTexture *texture = window()->createTextureFromImage(m_currentImage, QQuickWindow::TextureIsOpaque);
+        textureNode->setTexture(texture);
+        m_imageDirty = false;
+    }
+    textureNode->setRect(boundingRect());
+    return textureNode;
+}
+
+void VideoFrame::geometryChanged(const QRectF &newGeometry, const QRectF &oldGeometry)
+{
+    QQuickItem::geometryChanged(newGeometry, oldGeometry);
+    if (newGeometry.size() != oldGeometry.size()) {
+        updateOutputSize();
+        update();
+    }
+}
+
+void VideoFrame::itemChange(ItemChange change, const ItemChangeData &value)
+{
+    QQuickItem::itemChange(change, value);
+    // 移到其他屏幕或窗口时设备像素比可能变化
+    if (change == ItemSceneChange || change == ItemDevicePixelRatioHasChanged) {
+        updateOutputSize();
+    }
+}
+
+void VideoFrame::updateOutputSize()
+{
+    qreal ratio = window() ? window()->effectiveDevicePixelRatio() : 1.0;
+    m_videoRender->setOutputSize(qRound(width() * ratio), qRound(height() * ratio));
+}
+
+quint64 VideoFrame::getDroppedFrames() const
+{
+    return m_droppedFrames.load();
+}
+
+quint64 VideoFrame::getDecodeDroppedFrames() const
+{
+    return m_videoRender->getDecodeDroppedFrames();
+}
+
+quint64 VideoFrame::getLateFrames() const
+{
+    return m_videoRender->getLateFrames();
 }
 
 QImage VideoFrame::currentImage() const
@@ -103,6 +181,7 @@ void VideoFrame::setCurrentImage(const QImage &image)
     }
 
     m_currentImage = image;
+    m_imageDirty = true;
     emit currentImageChanged();
     update();
 }
@@ -5,10 +5,21 @@
 #define VIDEOFRAME_H
 
 #include <QImage>
-#include <QQuickPaintedItem>
+#include <QQuickItem>
+#include <atomic>
 #include "VideoRender.h"
 
-class VideoFrame : public QQuickPaintedItem
+/**
+ * @brief 视频显示控件
+ *
+ * 基于场景图直接显示：每显示一帧，在渲染线程的同步阶段把解码好的图像上传为纹理，
+ * 由 QSGSimpleTextureNode 拉伸到控件区域。不再经过 QPainter 绘制到中间缓冲再上传，
+ * 软件和 OpenGL 场景图后端都可以使用。
+ *
+ * 渲染线程把到期的帧发布到 VideoRender 的三缓冲信箱，本控件在下一次场景图同步时
+ * 只取最新一帧，界面繁忙期间被新帧覆盖的帧计入 getDroppedFrames()。
+ */
+class VideoFrame : public QQuickItem
 {
     Q_OBJECT
 
@@ -16,8 +27,6 @@ public:
     explicit VideoFrame(QQuickItem *parent = nullptr);
     ~VideoFrame();
 
-    void paint(QPainter *painter) override;
-
     QImage currentImage() const;
 
     Q_INVOKABLE void setPlaying(bool isPlaying);
@@ -28,7 +37,17 @@ public:
     Q_INVOKABLE int getDuration() const;
     Q_INVOKABLE int getTotalDuration() const;
     Q_INVOKABLE void seekTo(int seconds);
+    // 精确跳转，单位为毫秒；只投递请求，不阻塞界面
+    Q_INVOKABLE void seekToMs(qint64 positionMs);
+    // 最近一次跳转到显示第一帧的耗时（毫秒），尚未显示时为 -1
+    Q_INVOKABLE qint64 getSeekLatencyMs() const;
     Q_INVOKABLE void setPlaySpeed(float speed);
+    // 已到期但在显示前被新帧覆盖的帧数
+    Q_INVOKABLE quint64 getDroppedFrames() const;
+    // 解码跟不上时在解码端丢弃的帧数（跳帧和解码后已落后的帧）
+    Q_INVOKABLE quint64 getDecodeDroppedFrames() const;
+    // 到期时下一帧也已到期、未经转换直接丢弃的帧数
+    Q_INVOKABLE quint64 getLateFrames() const;
 
 signals:
     void currentImageChanged();
@@ -36,8 +55,20 @@ signals:
 public slots:
     void setCurrentImage(const QImage &image);
 
+protected:
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *data) override;
+    void geometryChanged(const QRectF &newGeometry, const QRectF &oldGeometry) override;
+    void itemChange(ItemChange change, const ItemChangeData &value) override;
+
 private:
+    // 把显示区域的物理像素尺寸通知解码端
+    void updateOutputSize();
+
     QImage m_currentImage;
+    // 当前图像尚未上传为纹理
+    bool m_imageDirty;
+    // 在渲染线程累加，任意线程读取
+    std::atomic<quint64> m_droppedFrames;
     VideoRender *m_videoRender;
 };
 
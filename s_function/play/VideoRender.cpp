@@ -1,34 +1,49 @@
 #include "VideoRender.h"
 #include "../play/AudioOutput.h"
-#include <QDateTime>
 #include <QDebug>
 
 VideoRender::VideoRender(QObject *parent)
     : QThread(parent)
+    , m_demuxer(new Demuxer(this))
     , m_videoCode(new VideoCode(this))
     , m_audioCode(new AudioCode(this))
-    , m_isPlaying(false)
-    , m_mutex()
     , m_videoDataQueue(m_videoCode->getVideoDataQueue())  // 引用必须在初始化列表中初始化
     , m_audioDataQueue(m_audioCode->getAudioDataQueue())  // 引用必须在初始化列表中初始化
-    , m_playQueueIndex(-1)
-    , m_lastTimestamp(0)
+    , m_frameNotifyPending(false)
+    , m_lateFrames(0)
+    , m_renderSerial(0)
+    , m_seekLatencySerial(-1)
+    , m_seekRequestUs(0)
+    , m_seekLatencyMs(-1)
     , m_currentTimestamp(0)
-    , m_lastPlayTimestamp(0)
-    , m_frameInterval(0)
+    , m_avOffset(0)
     , m_playSpeed(1.0f)
+    , m_trickRate(0)
+    , m_trickAnchorMs(0)
+    , m_trickAnchorUs(-1)
+    , m_lateSinceUs(-1)
+    , m_onTimeSinceUs(-1)
 {
-    
+    m_demuxer->setPlayerState(&m_playerState);
+    m_videoCode->setPlayerState(&m_playerState);
+    m_audioCode->setPlayerState(&m_playerState);
 }
 
 VideoRender::~VideoRender()
 {
     // 先停止线程
+    stop();
+    cleanup();
+}
+
+void VideoRender::stop()
+{
+    // 工作线程由渲染线程在退出前统一结束
+    m_playerState.requestQuit();
+    wakeRenderThread();
     if (isRunning()) {
-        setPlaying(false);
         wait();  // 等待线程结束
     }
-    cleanup();
 }
 
 void VideoRender::cleanup()
@@ -41,6 +56,11 @@ void VideoRender::cleanup()
         delete m_audioCode;
         m_audioCode = nullptr;
     }
+    // 解码器引用解复用器的包队列，最后释放
+    if (m_demuxer) {
+        delete m_demuxer;
+        m_demuxer = nullptr;
+    }
 }
 
 int VideoRender::getWidth() const
@@ -53,6 +73,23 @@ int VideoRender::getHeight() const
     return m_videoCode->getHeight();
 }
 
+void VideoRender::setOutputSize(int width, int height)
+{
+    m_videoConverter.setOutputSize(width, height);
+}
+
+bool VideoRender::takeLatestFrame(QImage &image, quint64 &dropped)
+{
+    // 先清除通知标志再取帧，取帧之后发布的新帧会再次发出通知
+    m_frameNotifyPending.store(false);
+    uint64_t skipped = 0;
+    if (!m_frameMailbox.take(image, &skipped)) {
+        return false;
+    }
+    dropped = skipped;
+    return true;
+}
+
 int VideoRender::getDuration() const
 {
     return m_currentTimestamp.load() / 1000;
@@ -60,46 +97,277 @@ int VideoRender::getDuration() const
 
 int VideoRender::getTotalDuration() const
 {
-    if (m_videoCode) {
-        return m_videoCode->getDuration();
+    if (m_demuxer) {
+        return m_demuxer->getDuration();
     }
     return 0;
 }
 
-bool VideoRender::isPlaying()
+bool VideoRender::isPlaying() const
 {
-    QMutexLocker locker(&m_mutex);
-    return m_isPlaying;
+    return PlayerState::isClockRunning(m_playerState.state());
+}
+
+bool VideoRender::play()
+{
+    bool playing = m_playerState.play();
+    // 状态变化已唤醒挂起在 waitActive() 上的线程，这里唤醒挂起在数据队列上的渲染线程
+    wakeRenderThread();
+    return playing;
+}
+
+void VideoRender::pause()
+{
+    m_playerState.pause();
+    wakeRenderThread();
 }
 
 void VideoRender::setPlaying(bool isPlaying)
 {
-    QMutexLocker locker(&m_mutex);
-    m_isPlaying = isPlaying;
+    if (isPlaying) {
+        play();
+    } else {
+        pause();
+    }
+}
+
+void VideoRender::wakeRenderThread()
+{
+    m_wakeEvent.wake();
+    m_audioDataQueue.notifyAll();
+    m_videoDataQueue.notifyAll();
 }
 
 void VideoRender::seekTo(int seconds)
 {
-    setPlaying(false);
-    // 同时跳转视频和音频，确保同步
-    if (m_videoCode) {
-        m_videoCode->seekTo(seconds);
+    seekToMs(static_cast<qint64>(seconds) * 1000);
+}
+
+void VideoRender::seekToMs(qint64 positionMs)
+{
+    if (positionMs < 0) {
+        positionMs = 0;
     }
-    if (m_audioCode) {
-        m_audioCode->seekTo(seconds);
+    // 快进/快退中跳转后继续快进/快退
+    requestSeek(positionMs, m_trickRate.load());
+}
+
+void VideoRender::requestSeek(qint64 positionMs, int trickRate)
+{
+    // 只投递请求：跳转、冲刷解码器、丢弃旧数据都由各工作线程按序号自行完成
+    int serial = m_demuxer->requestSeek(positionMs, trickRate);
+    if (serial < 0) {
+        // 没有打开文件
+        return;
+    }
+    m_seekRequestUs.store(AudioStream::currentTimeUs());
+    m_seekLatencyMs.store(-1);
+    m_seekLatencySerial.store(serial);
+    // 进度立即显示为跳转目标，新位置的音频开始播放后由音频时钟接管
+    m_currentTimestamp.store(positionMs);
+    m_avOffset.store(0);
+    wakeRenderThread();
+}
+
+void VideoRender::discardStaleData()
+{
+    int serial = m_demuxer->getRequestedSerial();
+    if (serial != m_renderSerial) {
+        m_renderSerial = serial;
+        // 输出流中还有旧位置的音频，冲刷后由混音线程丢弃，播放时钟随之重新建立
+        m_audioStream->flush();
+        // 新位置的时钟重新建立之前不按时钟丢帧，跳转前的落后统计作废，跳帧级别保留
+        m_videoCode->setMasterClock(-1);
+        m_lateSinceUs = -1;
+        m_onTimeSinceUs = -1;
+    }
+
+    // 旧序号的数据一定排在新数据之前，只需检查队头；丢弃后解码线程的预算随之释放
+    VideoData videoData;
+    const VideoData *nextFrame = m_videoDataQueue.peek();
+    while (nextFrame && nextFrame->serial != serial) {
+        m_videoDataQueue.pop(videoData);
+        nextFrame = m_videoDataQueue.peek();
+    }
+    AudioData audioData;
+    const AudioData *nextAudio = m_audioDataQueue.peek();
+    while (nextAudio && nextAudio->serial != serial) {
+        m_audioDataQueue.pop(audioData);
+        nextAudio = m_audioDataQueue.peek();
+    }
+}
+
+void VideoRender::publishFrame(VideoData &videoData)
+{
+    // 只转换选中显示的帧；转换后立即释放解码帧的引用
+    int serial = videoData.serial;
+    QImage image = m_videoConverter.convert(videoData.frame.get());
+    videoData.frame.reset();
+    if (image.isNull()) {
+        return;
+    }
+    // 移入信箱，渲染线程不再持有该帧；被覆盖的旧帧在下次发布时归还帧池
+    m_frameMailbox.publish(std::move(image));
+    if (!m_frameNotifyPending.exchange(true)) {
+        emit frameAvailable();
+    }
+    if (serial == m_seekLatencySerial.load()) {
+        m_seekLatencySerial.store(-1);
+        m_seekLatencyMs.store((AudioStream::currentTimeUs() - m_seekRequestUs.load()) / 1000);
+        qDebug() << "Seek to first frame latency:" << m_seekLatencyMs.load() << "ms";
+    }
+}
+
+void VideoRender::presentSeekFrame(int serial)
+{
+    VideoData videoData;
+    if (m_videoDataQueue.pop(videoData)) {
+        // 队头已经是新位置的帧，立即显示，暂停中跳转也能看到目标画面
+        m_currentTimestamp.store(videoData.timestamp);
+        publishFrame(videoData);
+        m_playerState.finishSeek(serial);
+        return;
+    }
+    if (m_demuxer->isEof() && m_videoCode->getDrainedSerial() == serial) {
+        // 目标位置之后没有视频帧（跳到了文件末尾），同样结束跳转
+        m_playerState.finishSeek(serial);
+    }
+}
+
+void VideoRender::updateFrameSkip(qint64 lagMs)
+{
+    int64_t nowUs = AudioStream::currentTimeUs();
+    int level = m_videoCode->getFrameSkipLevel();
+    if (lagMs > RENDER_LATE_THRESHOLD_MS) {
+        m_onTimeSinceUs = -1;
+        if (m_lateSinceUs < 0) {
+            m_lateSinceUs = nowUs;
+        } else if (nowUs - m_lateSinceUs >= static_cast<int64_t>(RENDER_SKIP_ESCALATE_MS) * 1000
+                   && level < VIDEO_FRAME_SKIP_MAX_LEVEL) {
+            m_videoCode->setFrameSkipLevel(level + 1);
+            // 新级别生效需要时间，重新计时后再决定是否继续提高
+            m_lateSinceUs = nowUs;
+            qDebug() << "Video behind audio by" << lagMs << "ms, frame skip level" << level + 1;
+        }
+        return;
+    }
+    m_lateSinceUs = -1;
+    if (lagMs > RENDER_LATE_RECOVER_MS || level == 0) {
+        m_onTimeSinceUs = -1;
+        return;
+    }
+    if (m_onTimeSinceUs < 0) {
+        m_onTimeSinceUs = nowUs;
+    } else if (nowUs - m_onTimeSinceUs >= static_cast<int64_t>(RENDER_SKIP_RECOVER_MS) * 1000) {
+        m_videoCode->setFrameSkipLevel(level - 1);
+        m_onTimeSinceUs = nowUs;
+        qDebug() << "Video caught up with audio, frame skip level" << level - 1;
+    }
+}
+
+void VideoRender::renderTrickPlay(int trickRate)
+{
+    // 按墙上时钟推进播放位置，倍率为负时倒退
+    int64_t nowUs = AudioStream::currentTimeUs();
+    if (m_trickAnchorUs < 0) {
+        m_trickAnchorUs = nowUs;
+        m_trickAnchorMs = m_currentTimestamp.load();
+    }
+    qint64 position = m_trickAnchorMs + (nowUs - m_trickAnchorUs) * trickRate / 1000;
+    qint64 endMs = static_cast<qint64>(getTotalDuration()) * 1000;
+    bool atBoundary = false;
+    if (position <= 0) {
+        position = 0;
+        atBoundary = trickRate < 0;
+    } else if (endMs > 0 && position >= endMs) {
+        position = endMs;
+        atBoundary = trickRate > 0;
+    }
+    m_currentTimestamp.store(position);
+
+    // 快进时时间戳不晚于当前位置的帧到期，快退时不早于当前位置的帧到期
+    auto isDue = [trickRate, position](const VideoData *frame) {
+        return trickRate > 0 ? frame->timestamp <= position : frame->timestamp >= position;
+    };
+    const VideoData *nextFrame = m_videoDataQueue.peek();
+    if (nextFrame && isDue(nextFrame)) {
+        VideoData videoData;
+        m_videoDataQueue.pop(videoData);
+        const VideoData *followingFrame = m_videoDataQueue.peek();
+        if (followingFrame && isDue(followingFrame)) {
+            // 解码跟不上倍率，跳过本帧，不做颜色转换
+            m_lateFrames.fetch_add(1);
+            return;
+        }
+        publishFrame(videoData);
+        return;
+    }
+    if (atBoundary) {
+        // 到达文件开头或末尾，停在最后显示的关键帧上
+        m_playerState.pause();
+        return;
+    }
+
+    // 挂起到下一个关键帧到期，媒体时间按倍率换算为实际等待时间
+    int64_t waitUs = static_cast<int64_t>(RENDER_IDLE_WAIT_MS) * 1000;
+    if (!nextFrame) {
+        m_videoDataQueue.waitForDataUs(waitUs);
+        return;
+    }
+    waitUs = qMin(waitUs, static_cast<int64_t>(qAbs(nextFrame->timestamp - position)) * 1000 / qAbs(trickRate));
+    uint32_t token = m_wakeEvent.prepareWait();
+    if (m_playerState.quitRequested() || m_playerState.state() != PlayerState::Playing
+            || m_trickRate.load() != trickRate) {
+        m_wakeEvent.cancelWait();
+        return;
+    }
+    m_wakeEvent.wait(token, waitUs);
+}
+
+void VideoRender::checkDrained(int serial)
+{
+    if (m_audioCode->getDrainedSerial() != serial || !m_audioDataQueue.empty()
+            || m_audioStream->bufferedDurationMs() > 0) {
+        return;
+    }
+    if (m_videoCode->getDrainedSerial() != serial) {
+        return;
+    }
+    // 音频已全部播完，时钟不再前进；剩余视频帧不会到期，只显示最后一帧
+    VideoData videoData;
+    VideoData lastFrame;
+    bool hasFrame = false;
+    while (m_videoDataQueue.pop(videoData)) {
+        lastFrame = std::move(videoData);
+        hasFrame = true;
+    }
+    if (hasFrame) {
+        m_currentTimestamp.store(lastFrame.timestamp);
+        publishFrame(lastFrame);
+    }
+    if (m_playerState.transition(PlayerState::Draining, PlayerState::Eof)) {
+        qDebug() << "VideoRender reached end of file";
     }
-    // 重置时间戳，避免显示错误的时间
-    m_lastTimestamp.store(0);
-    m_lastPlayTimestamp = 0;
-    m_currentTimestamp.store(0);
 }
 
 void VideoRender::setPlaySpeed(float speed)
 {
-    m_playSpeed.store(speed);
-    if (m_audioCode) {
-        m_audioCode->setPlaybackSpeed(speed);
+    int trickRate = 0;
+    if (speed < 0.0f || speed > AUDIO_TEMPO_MAX) {
+        int rate = qBound(TRICK_PLAY_MIN_RATE, qRound(qAbs(speed)), TRICK_PLAY_MAX_RATE);
+        trickRate = speed < 0.0f ? -rate : rate;
+    } else {
+        m_playSpeed.store(qBound(AUDIO_TEMPO_MIN, speed, AUDIO_TEMPO_MAX));
+        if (m_audioCode) {
+            m_audioCode->setPlaybackSpeed(speed);
+        }
     }
+    if (m_trickRate.exchange(trickRate) != trickRate) {
+        // 进入、退出快进/快退或改变倍率：从当前位置重新跳转，解复用器和解码器随序号切换模式
+        requestSeek(m_currentTimestamp.load(), trickRate);
+    }
+    // 倍速改变后下一帧的到期时间随之改变
+    wakeRenderThread();
 }
 
 bool VideoRender::openVideo(const QString &filePath)
@@ -107,25 +375,46 @@ bool VideoRender::openVideo(const QString &filePath)
     if(m_videoFilePath == filePath) {
         return true;
     }
+    // 所有线程都停下之后才能重新打开解复用器和解码器
+    stop();
+    m_playerState.setState(PlayerState::Opening);
     m_videoFilePath = filePath;
-    if (!m_videoCode->openVideo(filePath)) {
+    // 文件只打开、探测一次
+    if (!m_demuxer->openFile(filePath)) {
         qDebug() << "Failed to open video file:" << filePath;
+        m_videoFilePath.clear();
+        m_playerState.setState(PlayerState::Idle);
         return false;
     }
-    if (!m_audioCode->openAudio(filePath)) {
+    if (!m_videoCode->openVideo(m_demuxer)) {
+        qDebug() << "Failed to open video file:" << filePath;
+        m_videoFilePath.clear();
+        m_playerState.setState(PlayerState::Idle);
+        return false;
+    }
+    if (!m_audioCode->openAudio(m_demuxer)) {
         qDebug() << "Failed to open audio file:" << filePath;
+        m_videoFilePath.clear();
+        m_playerState.setState(PlayerState::Idle);
         return false;
     }
+    m_videoDataQueue.clear();
+    m_audioDataQueue.clear();
+    m_currentTimestamp.store(0);
+    // 新文件按正常倍速从头播放
+    m_trickRate.store(0);
+    // 工作线程在打开时启动并挂起在 Paused，播放/暂停只切换状态
+    m_playerState.resetQuit();
+    m_playerState.setState(PlayerState::Paused);
+    start();
     return true;
 }
 
 void VideoRender::closeVideo()
 {
-    setPlaying(false);
+    stop();
+    m_playerState.setState(PlayerState::Idle);
     m_videoFilePath.clear();
-    m_lastTimestamp.store(0);
-    m_lastPlayTimestamp = 0;
-    m_frameInterval = 0;
     m_videoDataQueue.clear();
     m_audioDataQueue.clear();
     m_currentTimestamp.store(0);
@@ -133,65 +422,151 @@ void VideoRender::closeVideo()
 
 void VideoRender::run()
 {
-    m_playQueueIndex = AudioOutput::getInstance()->addThreadIdToPlayQueue(reinterpret_cast<qintptr>(QThread::currentThreadId()));
-    
-    // 检查队列索引是否有效
-    if (m_playQueueIndex < 0) {
-        qDebug() << "Failed to add thread to play queue, queue is full!";
-        return;
-    }
-    
+    m_audioStream = AudioOutput::getInstance()->openStream(
+        AudioOutput::getInstance()->bytesForDuration(RENDER_AUDIO_BUFFER_MS));
+    // 音频时钟只在 Playing/Draining 时走动，其余状态暂停输出流
+    bool clockRunning = PlayerState::isClockRunning(m_playerState.state());
+    m_audioStream->setPaused(!clockRunning);
+
+    m_demuxer->start();
     m_videoCode->start();
     m_audioCode->start();
-    setPlaying(true);
     AudioData audioData;
     VideoData videoData;
-    qDebug() << "VideoRender run " << m_playQueueIndex;
-    
-    while (true) {
-        if (!isPlaying()) {
-            break;
+    qDebug() << "VideoRender run";
+
+    m_renderSerial = m_demuxer->getRequestedSerial();
+    while (!m_playerState.quitRequested()) {
+        PlayerState::State state = m_playerState.state();
+        int trickRate = m_trickRate.load();
+        // 快进/快退时静音，音频时钟停止
+        bool running = PlayerState::isClockRunning(state) && trickRate == 0;
+        if (running != clockRunning) {
+            clockRunning = running;
+            m_audioStream->setPaused(!clockRunning);
+            if (!clockRunning) {
+                // 时钟停止期间解码出的帧不算落后
+                m_videoCode->setMasterClock(-1);
+            }
+        }
+        if (state != PlayerState::Playing) {
+            // 快进/快退暂停或跳转后从当前位置重新开始推进
+            m_trickAnchorUs = -1;
+        }
+        if (!PlayerState::isActive(state)) {
+            // 暂停或播放结束：挂起到状态变化，恢复播放只需一次唤醒
+            m_playerState.waitActive(static_cast<int64_t>(RENDER_IDLE_WAIT_MS) * 1000);
+            continue;
         }
 
-        if(m_videoDataQueue.front(videoData))
-        {
-            // 以音频时间戳为基准同步
-            if(videoData.timestamp <= m_currentTimestamp.load())
-            {
-                emit videoFrameReady(videoData.image);
-                m_videoDataQueue.pop(videoData);
+        discardStaleData();
+        int serial = m_renderSerial;
+        float speed = m_playSpeed.load();
+        if (speed <= 0.0f) {
+            speed = 1.0f;
+        }
+
+        if (state == PlayerState::Seeking) {
+            presentSeekFrame(serial);
+            if (m_playerState.state() != PlayerState::Seeking) {
+                continue;
             }
+            // 等待新位置的第一帧期间先预先写入音频，跳转完成后立即出声
+            if (m_audioStream->bufferedDurationMs() < RENDER_AUDIO_AHEAD_MS && m_audioDataQueue.pop(audioData)) {
+                m_audioStream->write(audioData.audioData, audioData.timestamp, audioData.speed);
+                continue;
+            }
+            m_videoDataQueue.waitForDataUs(static_cast<int64_t>(RENDER_CLOCK_POLL_MS) * 1000);
+            continue;
         }
 
-        qint64 currentTimestamp = QDateTime::currentMSecsSinceEpoch();
-        if(currentTimestamp - m_lastPlayTimestamp < m_frameInterval) {
-            msleep(1);  // 避免CPU占用过高
+        if (trickRate != 0) {
+            // 快进/快退没有音频时钟，也不进入 Draining，到达文件两端时暂停
+            renderTrickPlay(trickRate);
             continue;
         }
 
-        // 以音频数据时间戳为基准
-        if(m_audioDataQueue.pop(audioData))
-        {
-            AudioOutput::getInstance()->addAudioDataToQueue(m_playQueueIndex, audioData.audioData);
-            if(audioData.timestamp - m_lastTimestamp.load() >= 0 && m_lastTimestamp.load() != 0)
-            {
-                m_frameInterval = audioData.timestamp - m_lastTimestamp.load();
+        if (state == PlayerState::Playing && m_demuxer->isEof()) {
+            // 数据包已全部读出，剩余的已解码数据播完后进入 Eof
+            m_playerState.transition(PlayerState::Playing, PlayerState::Draining);
+        } else if (state == PlayerState::Draining) {
+            checkDrained(serial);
+        }
+
+        // 以扬声器正在播放的音频 PTS 作为主时钟，视频跟随音频
+        qint64 clock = 0;
+        bool hasClock = m_audioStream->playbackPosition(clock);
+        if (hasClock) {
+            m_currentTimestamp.store(clock);
+        }
+        // 解码端据此丢弃已落后的帧
+        m_videoCode->setMasterClock(hasClock ? clock : -1);
+
+        // 挂起时长取各个事件中最早的到期时间
+        int64_t waitUs = static_cast<int64_t>(hasClock ? RENDER_IDLE_WAIT_MS : RENDER_CLOCK_POLL_MS) * 1000;
+
+        // 只查看队头帧的时间戳，不拷贝；到期后再移出并显示
+        const VideoData *nextFrame = m_videoDataQueue.peek();
+        if (nextFrame && hasClock) {
+            if (nextFrame->timestamp <= clock) {
+                qint64 lagMs = clock - nextFrame->timestamp;
+                m_avOffset.store(lagMs);
+                updateFrameSkip(lagMs);
+                m_videoDataQueue.pop(videoData);
+                const VideoData *followingFrame = m_videoDataQueue.peek();
+                if (followingFrame && followingFrame->timestamp <= clock) {
+                    // 下一帧也已到期，本帧不会被看到，直接丢弃，不做颜色转换
+                    m_lateFrames.fetch_add(1);
+                    videoData.frame.reset();
+                    continue;
+                }
+                publishFrame(videoData);
+                continue;
             }
-            qint64 temp = m_currentTimestamp.load();
-            if(temp == 0){
-                m_currentTimestamp.store(audioData.timestamp);
-            }else{
-                m_currentTimestamp.store(temp + (int)(m_playSpeed.load() * m_frameInterval));
+            // 媒体时间按倍速换算为实际等待时间
+            waitUs = qMin(waitUs, static_cast<int64_t>((nextFrame->timestamp - clock) * 1000 / speed));
+        }
+
+        // 音频流中只保留少量待播放数据，数据的时间戳随数据一起交给输出端
+        qint64 bufferedMs = m_audioStream->bufferedDurationMs();
+        bool needAudio = bufferedMs < RENDER_AUDIO_AHEAD_MS;
+        if (needAudio && m_audioDataQueue.pop(audioData)) {
+            m_audioStream->write(audioData.audioData, audioData.timestamp, audioData.speed);
+            continue;
+        }
+        if (bufferedMs > RENDER_AUDIO_LOW_MS) {
+            // 待播放数据降到低水位时醒来补充
+            waitUs = qMin(waitUs, static_cast<int64_t>(bufferedMs - RENDER_AUDIO_LOW_MS) * 1000);
+        }
+
+        // 选择等待对象：缺音频时等音频数据，没有视频帧时等视频数据，否则定时等到下一帧到期
+        // 暂停、停止、跳转、倍速改变时 wakeRenderThread() 会唤醒所有等待对象
+        if (needAudio && bufferedMs <= RENDER_AUDIO_LOW_MS) {
+            m_audioDataQueue.waitForDataUs(waitUs);
+        } else if (!nextFrame) {
+            m_videoDataQueue.waitForDataUs(waitUs);
+        } else {
+            uint32_t token = m_wakeEvent.prepareWait();
+            if (m_playerState.quitRequested() || m_playerState.state() != state) {
+                m_wakeEvent.cancelWait();
+                continue;
             }
-            m_lastTimestamp.store(audioData.timestamp);
-            m_lastPlayTimestamp = currentTimestamp;
+            m_wakeEvent.wait(token, waitUs);
         }
     }
-    
+
     qDebug() << "VideoRender run end";
-    m_videoCode->setPlaying(false);
-    m_audioCode->setPlaying(false);
-    if (m_playQueueIndex >= 0) {
-        AudioOutput::getInstance()->removeThreadIdFromPlayQueue(m_playQueueIndex);
+    // 工作线程与渲染线程一起退出
+    m_playerState.requestQuit();
+    m_demuxer->wakeUp();
+    m_videoCode->wakeUp();
+    m_audioCode->wakeUp();
+    m_demuxer->wait();
+    m_videoCode->wait();
+    m_audioCode->wait();
+    if (m_audioStream) {
+        AudioOutput::getInstance()->closeStream(m_audioStream);
+        m_audioStream.reset();
     }
-}
\ No newline at end of file
+    m_videoConverter.reset();
+}
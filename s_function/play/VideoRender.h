@@ -1,9 +1,29 @@
 #ifndef VIDEORENDER_H
 #define VIDEORENDER_H
 
+#include "../unCode/Demuxer.h"
 #include "../unCode/VideoCode.h"
 #include "../unCode/AudioCode.h"
+#include "../unCode/VideoConverter.h"
+#include "../models/TripleBuffer.h"
+#include "../models/WaitEvent.h"
+#include "../models/PlayerState.h"
 #include <atomic>
+#include <memory>
+
+class AudioStream;
+
+#define RENDER_CLOCK_POLL_MS 5 // 音频时钟建立之前检查时钟的间隔
+#define RENDER_IDLE_WAIT_MS 100 // 没有待显示帧时单次挂起的最长时间
+#define RENDER_AUDIO_AHEAD_MS 200 // 音频流中最多保留的待播放数据时长
+#define RENDER_AUDIO_BUFFER_MS (2 * RENDER_AUDIO_AHEAD_MS) // 输出流缓冲区时长，超出预读时长的部分容纳单次写入的一帧音频
+#define RENDER_AUDIO_LOW_MS 100 // 音频流中待播放数据低于该时长时唤醒补充
+#define RENDER_LATE_THRESHOLD_MS 80 // 到期帧落后主时钟超过该时长视为解码跟不上
+#define RENDER_LATE_RECOVER_MS 20 // 到期帧落后不超过该时长视为已跟上
+#define RENDER_SKIP_ESCALATE_MS 500 // 持续落后该时长后提高一级跳帧
+#define RENDER_SKIP_RECOVER_MS 3000 // 持续跟上该时长后降低一级跳帧
+#define TRICK_PLAY_MIN_RATE 4 // 快进/快退的最低倍率
+#define TRICK_PLAY_MAX_RATE 32 // 快进/快退的最高倍率
 
 class VideoRender : public QThread
 {
@@ -12,8 +32,18 @@ public:
     explicit VideoRender(QObject *parent = nullptr);
     ~VideoRender();
 
-    bool isPlaying();
+    // 音频时钟是否在走（Playing 或 Draining）
+    bool isPlaying() const;
+    /**
+     * @brief 开始/继续播放，任意线程调用，不阻塞
+     *
+     * 工作线程在打开文件时启动，暂停期间只是挂起，恢复播放只需唤醒，不重建线程。
+     * @return false 没有打开文件或已播放结束（播放结束后先跳转再播放）
+     */
+    bool play();
+    void pause();
     void setPlaying(bool isPlaying);
+    PlayerState::State getPlayerState() const { return m_playerState.state(); }
     bool openVideo(const QString &filePath);
     void closeVideo();
     int getWidth() const;
@@ -23,40 +53,123 @@ public:
 
     // 跳转到指定时间，单位为秒
     void seekTo(int seconds);
+    /**
+     * @brief 精确跳转到指定时间（毫秒），任意线程调用，不阻塞
+     *
+     * 只向解复用线程投递跳转请求，界面线程不接触任何 FFmpeg 状态。
+     * 拖动进度条时连续的请求只执行最后一个；解复用器跳到目标之前最近的关键帧，
+     * 音视频解码器丢弃目标之前的数据，渲染线程丢弃旧位置的帧和音频。
+     * 暂停时同样立即执行并显示目标帧，之后保持暂停。
+     */
+    void seekToMs(qint64 positionMs);
+    // 最近一次跳转从请求到显示第一帧的耗时（毫秒），尚未显示时为 -1
+    qint64 getSeekLatencyMs() const { return m_seekLatencyMs.load(); }
 
-    // 设置播放倍速
+    /**
+     * @brief 设置播放倍速
+     *
+     * AUDIO_TEMPO_MIN~AUDIO_TEMPO_MAX 由音频变速实现，音视频照常同步；倍速高于 AUDIO_TEMPO_MAX 或为负数时
+     * 进入快进/快退：静音，只解码关键帧，按墙上时钟以该倍率推进播放位置（负数倒退），
+     * 到达文件开头或末尾时暂停。切换模式和倍率都从当前位置重新跳转。
+     */
     void setPlaySpeed(float speed);
+    // 快进/快退倍率，正数快进、负数快退，0 表示正常播放
+    int getTrickPlayRate() const { return m_trickRate.load(); }
+
+    // 设置显示区域的物理像素尺寸，解码端直接按该尺寸输出图像
+    void setOutputSize(int width, int height);
+
+    // 最近一次显示视频帧时的音视频偏差（毫秒），正值表示视频晚于音频
+    qint64 getAvOffset() const { return m_avOffset.load(); }
+    // 显示端丢弃的帧数：到期时下一帧也已到期、因而未经转换直接丢弃的帧
+    quint64 getLateFrames() const { return m_lateFrames.load(); }
+    // 解码端丢弃的帧数：按跳帧级别跳过的帧和解码后已落后主时钟而丢弃的帧
+    quint64 getDecodeDroppedFrames() const { return m_videoCode->getDroppedFrames(); }
+    // 当前跳帧级别，0 表示正常解码
+    int getFrameSkipLevel() const { return m_videoCode->getFrameSkipLevel(); }
+
+    /**
+     * @brief 取走最新一帧（仅由显示端一个线程调用）
+     * @param dropped 输出自上次取帧以来被新帧覆盖、未被显示的帧数
+     * @return false 没有新帧
+     */
+    bool takeLatestFrame(QImage &image, quint64 &dropped);
 
 signals:
-    void videoFrameReady(const QImage &image);
+    // 有新帧可取。显示端取帧之前不会重复发出，界面繁忙时事件不会堆积
+    void frameAvailable();
 
 private:
     void run() override;
     void cleanup();
+    // 要求渲染线程和所有工作线程退出并等待结束
+    void stop();
+    // 跳转中：显示新位置的第一帧后结束跳转，不等待音频时钟
+    void presentSeekFrame(int serial);
+    // 数据全部播完后进入 Eof
+    void checkDrained(int serial);
+    // 把帧移入信箱并通知显示端
+    void publishFrame(VideoData &videoData);
+    // 投递跳转请求并开始统计跳转耗时
+    void requestSeek(qint64 positionMs, int trickRate);
+    /**
+     * @brief 按到期帧落后主时钟的时长调整解码端跳帧级别
+     *
+     * 持续落后时逐级提高（跳过非参考帧，再跳过所有B帧），持续跟上时逐级降低，
+     * 两个阈值之间保持不变，避免在临界负载下来回切换。
+     */
+    void updateFrameSkip(qint64 lagMs);
+    // 快进/快退：按倍率推进播放位置，显示到期的关键帧，没有到期的帧时挂起
+    void renderTrickPlay(int trickRate);
+    // 唤醒挂起在任意等待对象上的渲染线程
+    void wakeRenderThread();
+    // 有新的跳转请求时丢弃旧位置的待播放音频，并丢弃队头不属于该请求的帧和音频
+    void discardStaleData();
 
+    // 每个播放器一个解复用线程，音视频解码共享同一份数据包
+    Demuxer *m_demuxer;
     VideoCode *m_videoCode;
     AudioCode *m_audioCode;
 
-    bool m_isPlaying;
-    QMutex m_mutex;
+    // 渲染、解复用、音视频解码线程共享的播放器状态
+    PlayerState m_playerState;
     // 队列引用，必须在初始化列表中初始化
-    SPSCLockFreeQueue<VideoData, MAX_VIDEO_BUFFER_SIZE> &m_videoDataQueue;
-    SPSCLockFreeQueue<AudioData, MAX_AUDIO_BUFFER_SIZE> &m_audioDataQueue;
+    VideoDataQueue &m_videoDataQueue;
+    AudioDataQueue &m_audioDataQueue;
+    // 渲染线程按时间挂起时使用，停止/跳转时唤醒
+    WaitEvent m_wakeEvent;
+    // 到期的视频帧发布到这里，显示端只取最新一帧
+    TripleBuffer<QImage> m_frameMailbox;
+    // 已发出 frameAvailable 且显示端还未取帧
+    std::atomic<bool> m_frameNotifyPending;
+    // 解码帧到 RGB 图像的转换，只处理选中显示的帧，仅由渲染线程使用
+    VideoConverter m_videoConverter;
+    std::atomic<quint64> m_lateFrames;
+    // 渲染线程当前接受的跳转序号，只由渲染线程访问
+    int m_renderSerial;
+    // 跳转耗时统计：请求时记录序号和时刻，渲染线程显示该序号的第一帧时结束，序号 -1 表示没有待统计的跳转
+    std::atomic<int> m_seekLatencySerial;
+    std::atomic<qint64> m_seekRequestUs;
+    std::atomic<qint64> m_seekLatencyMs;
 
-    // 播放队列索引
-    int m_playQueueIndex;
+    // 输出音频流，每次播放时打开，停止时关闭
+    std::shared_ptr<AudioStream> m_audioStream;
     // 视频文件路径
     QString m_videoFilePath;
-    // 上一帧时间戳
-    std::atomic<qint64> m_lastTimestamp;
-    // 当前帧时间戳
+    // 音频主时钟：扬声器正在播放的 PTS（毫秒）
     std::atomic<qint64> m_currentTimestamp;
-    //上一帧播放时间戳
-    qint64 m_lastPlayTimestamp;
-    // 帧间间隔
-    int m_frameInterval;
+    // 音视频偏差（毫秒）
+    std::atomic<qint64> m_avOffset;
     // 播放倍速
     std::atomic<float> m_playSpeed;
+    // 快进/快退倍率，0 表示正常播放
+    std::atomic<int> m_trickRate;
+    // 快进/快退的起点：开始推进时的播放位置和时刻，时刻为 -1 表示尚未开始，只由渲染线程访问
+    qint64 m_trickAnchorMs;
+    int64_t m_trickAnchorUs;
+    // 跳帧调整：开始持续落后、开始持续跟上的时刻，-1 表示不在该状态，只由渲染线程访问
+    int64_t m_lateSinceUs;
+    int64_t m_onTimeSinceUs;
 };
 
 
@@ -1,12 +1,20 @@
 HEADERS += \
     $$PWD/AudioInput.h \
+    $$PWD/AudioMixer.h \
     $$PWD/AudioOutput.h \
+    $$PWD/AudioPullDevice.h \
+    $$PWD/AudioStream.h \
+    $$PWD/PcmRingBuffer.h \
     $$PWD/VideoFrame.h \
     $$PWD/VideoRender.h
 
 SOURCES += \
     $$PWD/AudioInput.cpp \
+    $$PWD/AudioMixer.cpp \
     $$PWD/AudioOutput.cpp \
+    $$PWD/AudioPullDevice.cpp \
+    $$PWD/AudioStream.cpp \
+    $$PWD/PcmRingBuffer.cpp \
     $$PWD/VideoFrame.cpp \
     $$PWD/VideoRender.cpp
 
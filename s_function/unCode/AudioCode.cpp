@@ -5,20 +5,30 @@
 
 AudioCode::AudioCode(QObject *parent)
     : QThread(parent)
-    , m_formatContext(nullptr)
+    , m_demuxer(nullptr)
+    , m_packetQueue(nullptr)
     , m_audioCodecContext(nullptr)
     , m_swrContext(nullptr)
-    , m_audioStreamIndex(-1)
-    , m_packet(nullptr)
     , m_audioFrame(nullptr)
+    , m_filteredFrame(nullptr)
+    , m_audioStream(nullptr)
+    , m_pendingPacket(nullptr)
+    , m_flushSent(false)
+    , m_serial(0)
+    , m_seekTargetMs(-1)
     , m_audioBuffer(nullptr)
     , m_audioBufferSize(0)
-    , m_filterGraph(nullptr)
-    , m_buffersrcCtx(nullptr)
-    , m_buffersinkCtx(nullptr)
-    , m_playbackSpeed(1.0f)
+    , m_requestedSpeed(1.0f)
+    , m_appliedSpeed(1.0f)
+    , m_filterStartPts(AV_NOPTS_VALUE)
+    , m_filterMediaSamples(0.0)
+    , m_filterInputSamples(0)
+    , m_filterDiscardSamples(0.0)
+    , m_fadeInPos(-1)
     , m_isOpened(false)
-    , m_isPlaying(true)
+    , m_playerState(nullptr)
+    , m_drainedSerial(-1)
+    , m_decodeBudget(AUDIO_DECODE_AHEAD_BYTES, AUDIO_DECODE_AHEAD_MS)
 {
     
 }
@@ -27,89 +37,91 @@ AudioCode::~AudioCode()
 {
     // 先停止线程并等待结束，避免 "Destroyed while thread is still running" 错误
     if (isRunning()) {
-        setPlaying(false);
+        m_playerState->requestQuit();
+        wakeUp();
         wait();  // 等待线程结束
     }
     closeAudio();
 }
 
-void AudioCode::setPlaying(bool isPlaying)
+void AudioCode::wakeUp()
 {
-    QMutexLocker locker(&m_mutex);
-    m_isPlaying = isPlaying;
-}
-
-bool AudioCode::isPlaying()
-{
-    QMutexLocker locker(&m_mutex);
-    return m_isPlaying;
+    if (m_packetQueue) {
+        m_packetQueue->notifyAll();
+    }
+    m_audioDataQueue.notifyAll();
 }
 
-void AudioCode::seekTo(int seconds)
+void AudioCode::flush()
 {
-    if (!m_isOpened || !m_formatContext || m_audioStreamIndex < 0) {
-        qDebug() << "Cannot seek: audio not opened";
-        return;
-    }
-
-    // 将秒数转换为 AV_TIME_BASE 单位的时间戳
-    // AV_TIME_BASE 通常是 1000000 (微秒)
-    int64_t timestamp = static_cast<int64_t>(seconds) * AV_TIME_BASE;
-    
-    // 使用 av_seek_frame 跳转到指定位置
-    // 参数说明：
-    // - m_formatContext: 格式上下文
-    // - -1: 对所有流进行跳转（如果使用 -1，timestamp 必须是 AV_TIME_BASE 单位）
-    // - timestamp: 目标时间戳
-    // - AVSEEK_FLAG_BACKWARD: 向后查找最近的 keyframe（更安全）
-    int ret = av_seek_frame(m_formatContext, -1, timestamp, AVSEEK_FLAG_BACKWARD);
-    
-    if (ret < 0) {
-        qDebug() << "Failed to seek to position:" << seconds << "seconds";
-        return;
-    }
-
     // 清空解码器缓冲区，确保从新位置开始解码
     if (m_audioCodecContext) {
         avcodec_flush_buffers(m_audioCodecContext);
     }
-
-    // 重新初始化过滤器，完全清空所有缓冲区
-    // 这是最彻底的方法，确保过滤器从干净状态开始
-    if (m_filterGraph) {
-        initAudioFilter(m_playbackSpeed);
+    if (m_pendingPacket) {
+        av_packet_free(&m_pendingPacket);
+    }
+    m_flushSent = false;
+    m_seekTargetMs = -1;
+
+    // 过滤器没有清空接口：换上备用图，旧图连同缓存的旧位置样本一起释放；
+    // 备用图在解码线程空闲时补建，跳转路径上不建图
+    if (m_tempoGraph.graph) {
+        if (m_spareGraph.graph) {
+            freeTempoGraph(m_tempoGraph);
+            m_tempoGraph = m_spareGraph;
+            m_spareGraph = TempoGraph();
+            m_filterDiscardSamples = 0.0;
+            // 新图的各级 atempo 为 1.0，送入下一帧之前重新应用倍速
+            m_appliedSpeed = 1.0f;
+        } else if (!m_tempoGraph.eof) {
+            // 连续跳转时备用图尚未补建：沿用旧图，旧位置残留的样本输出时按累计的样本数丢弃；
+            // 上一次跳转尚未丢弃完的残留仍在图中，一并累加
+            m_filterDiscardSamples += qMax(0.0, m_filterInputSamples - m_filterMediaSamples);
+        } else {
+            // 已送入结束标记的旧图不能再接收帧，备用图又建立失败：不再变速
+            qDebug() << "No spare audio tempo filter, playback speed disabled";
+            freeTempoGraph(m_tempoGraph);
+        }
     }
+    m_filterStartPts = AV_NOPTS_VALUE;
+    m_filterMediaSamples = 0.0;
+    m_filterInputSamples = 0;
+    m_fadeInPos = 0;
+}
 
-    // 清空音频数据队列，避免显示旧帧
-    m_audioDataQueue.clear();
+void AudioCode::syncSerial()
+{
+    int serial = m_demuxer->getSerial();
+    if (serial == m_serial) {
+        return;
+    }
+    // 解码器和过滤器中缓存的旧位置的样本全部丢弃，从新位置开始解码
+    flush();
+    m_serial = serial;
+    m_seekTargetMs = m_demuxer->getSeekTarget();
+}
 
-    qDebug() << "Seeked to position:" << seconds << "seconds";
+void AudioCode::setDecodeAheadLimit(qint64 maxBytes, qint64 maxAheadMs)
+{
+    m_decodeBudget.setLimits(maxBytes, maxAheadMs);
 }
 
-bool AudioCode::openAudio(const QString &filePath)
+bool AudioCode::openAudio(Demuxer *demuxer)
 {
     closeAudio(); // 先清理之前的资源
 
-    // 打开文件
-    if (avformat_open_input(&m_formatContext, filePath.toUtf8().constData(), nullptr, nullptr) < 0) {
-        qDebug() << "Failed to open audio file:" << filePath;
-        return false;
-    }
-
-    if (avformat_find_stream_info(m_formatContext, nullptr) < 0) {
-        qDebug() << "Failed to find stream info";
-        return false;
-    }
-
-    // 查找音频流
-    m_audioStreamIndex = av_find_best_stream(m_formatContext, AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0);
-    if (m_audioStreamIndex < 0) {
+    if (!demuxer || !demuxer->isOpened() || demuxer->getAudioStreamIndex() < 0) {
         qDebug() << "No audio stream found";
         return false;
     }
+    m_demuxer = demuxer;
+    m_packetQueue = &demuxer->getAudioPacketQueue();
+    m_serial = demuxer->getSerial();
+    m_seekTargetMs = -1;
 
-    m_audioStream = m_formatContext->streams[m_audioStreamIndex];
-    AVCodecParameters *audioParams = m_formatContext->streams[m_audioStreamIndex]->codecpar;
+    m_audioStream = demuxer->getAudioStream();
+    AVCodecParameters *audioParams = m_audioStream->codecpar;
     const AVCodec *audioCodec = avcodec_find_decoder(audioParams->codec_id);
     
     if (!audioCodec) {
@@ -133,19 +145,42 @@ bool AudioCode::openAudio(const QString &filePath)
         return false;
     }
     
-    // 初始化音频重采样 - 单声道
-    // 使用新版本FFmpeg的API
+    // 变速过滤器始终在数据通路上，倍速改变只发送命令，不切换通路；建立失败时不变速直接输出
+    if (!buildTempoGraph(m_tempoGraph)) {
+        qDebug() << "Audio tempo filter unavailable, playback speed disabled";
+    }
+    buildTempoGraph(m_spareGraph);
+    m_appliedSpeed = 1.0f;
+    m_filterStartPts = AV_NOPTS_VALUE;
+    m_filterMediaSamples = 0.0;
+    m_filterInputSamples = 0;
+    m_filterDiscardSamples = 0.0;
+    m_fadeInPos = -1;
+
+    // 初始化音频重采样 - 单声道，输入格式取过滤器的实际输出格式
     AVChannelLayout out_ch_layout = AV_CHANNEL_LAYOUT_MONO;
+    AVChannelLayout in_ch_layout;
+    AVSampleFormat in_sample_fmt = m_audioCodecContext->sample_fmt;
+    int in_sample_rate = m_audioCodecContext->sample_rate;
+    if (m_tempoGraph.graph) {
+        av_buffersink_get_ch_layout(m_tempoGraph.sink, &in_ch_layout);
+        in_sample_fmt = static_cast<AVSampleFormat>(av_buffersink_get_format(m_tempoGraph.sink));
+        in_sample_rate = av_buffersink_get_sample_rate(m_tempoGraph.sink);
+    } else {
+        av_channel_layout_copy(&in_ch_layout, &m_audioCodecContext->ch_layout);
+    }
     m_swrContext = swr_alloc();
     if (!m_swrContext) {
         qDebug() << "Failed to allocate swr context";
+        av_channel_layout_uninit(&in_ch_layout);
         return false;
     }
 
     swr_alloc_set_opts2(&m_swrContext,
                     &out_ch_layout, AV_SAMPLE_FMT_S16, 44100,
-                    &m_audioCodecContext->ch_layout, m_audioCodecContext->sample_fmt, m_audioCodecContext->sample_rate,
+                    &in_ch_layout, in_sample_fmt, in_sample_rate,
                     0, nullptr);
+    av_channel_layout_uninit(&in_ch_layout);
     
     if (swr_init(m_swrContext) < 0) {
         qDebug() << "Failed to initialize swr context";
@@ -153,19 +188,15 @@ bool AudioCode::openAudio(const QString &filePath)
     }
 
     // 分配内存
-    m_packet = av_packet_alloc();
     m_audioFrame = av_frame_alloc();
+    m_filteredFrame = av_frame_alloc();
 
-    if (!m_packet || !m_audioFrame) {
-        qDebug() << "Failed to allocate packet or frame";
+    if (!m_audioFrame || !m_filteredFrame) {
+        qDebug() << "Failed to allocate frame";
         return false;
     }
 
     m_isOpened = true;
-    
-    // 初始化音频过滤器（默认1.0倍速）
-    initAudioFilter(1.0f);
-    
     qDebug() << "Audio opened successfully";
     return true;
 }
@@ -174,112 +205,290 @@ bool AudioCode::getNextFrame()
 {
     if (!m_isOpened) return false;
 
-    while (av_read_frame(m_formatContext, m_packet) >= 0) {
-        if (m_packet->stream_index == m_audioStreamIndex) {
-            // 解码音频
-            if (avcodec_send_packet(m_audioCodecContext, m_packet) >= 0) {
-                if (avcodec_receive_frame(m_audioCodecContext, m_audioFrame) == 0) {
-                    AVFrame *frameToProcess = m_audioFrame;
-                    AVFrame *filteredFrame = nullptr;
-                    
-                    // 如果启用了过滤器，应用倍速处理
-                    if (m_filterGraph && m_playbackSpeed != 1.0f) {
-                        // 将原始帧添加到过滤器输入
-                        int ret = av_buffersrc_add_frame_flags(m_buffersrcCtx, m_audioFrame, AV_BUFFERSRC_FLAG_KEEP_REF);
-                        if (ret < 0) {
-                            av_packet_unref(m_packet);
-                            continue;
-                        }
-                        
-                        // 从过滤器输出获取处理后的帧
-                        filteredFrame = av_frame_alloc();
-                        if (!filteredFrame) {
-                            av_packet_unref(m_packet);
-                            continue;
-                        }
-                        
-                        ret = av_buffersink_get_frame(m_buffersinkCtx, filteredFrame);
-                        if (ret < 0) {
-                            av_frame_free(&filteredFrame);
-                            av_packet_unref(m_packet);
-                            continue;
-                        }
-                        frameToProcess = filteredFrame;
-                    }
-                    
-                    // 重采样音频 - 单声道
-                    int outSamples = av_rescale_rnd(frameToProcess->nb_samples, 44100, m_audioCodecContext->sample_rate, AV_ROUND_UP);
-                    int outBufferSize = av_samples_get_buffer_size(nullptr, 1, outSamples, AV_SAMPLE_FMT_S16, 1);
-                    
-                    if (m_audioBufferSize < outBufferSize) {
-                        av_free(m_audioBuffer);
-                        m_audioBuffer = (uint8_t*)av_malloc(outBufferSize);
-                        m_audioBufferSize = outBufferSize;
-                    }
-
-                    uint8_t *outData[1] = {m_audioBuffer};
-                    int outSamplesActual = swr_convert(m_swrContext, outData, outSamples, 
-                                                     (const uint8_t**)frameToProcess->data, frameToProcess->nb_samples);
-
-                    if (outSamplesActual > 0) {
-                        // 单声道：样本数 × 1通道 × 2字节/样本
-                        QByteArray data((char*)m_audioBuffer, outSamplesActual * 1 * 2);
-                        
-                        AudioData audioData;
-                        audioData.audioData = data;
-                        if (frameToProcess->pts != AV_NOPTS_VALUE) {
-                            int64_t pts = frameToProcess->pts;
-                            audioData.timestamp = av_rescale_q(pts, 
-                                                               m_audioStream->time_base, 
-                                                               AV_TIME_BASE_Q) / 1000; // 转换为毫秒
-                        } else {
-                            audioData.timestamp = 0;
-                        }
-                        m_audioDataQueue.push(audioData);
-                        
-                        // 释放过滤后的帧
-                        if (filteredFrame) {
-                            av_frame_free(&filteredFrame);
-                        }
-                        
-                        av_packet_unref(m_packet);
-                        return true; // 音频帧解码成功，返回true
-                    }
-                    
-                    // 清理过滤后的帧
-                    if (filteredFrame) {
-                        av_frame_free(&filteredFrame);
-                    }
-                }
+    syncSerial();
+
+    // 先取出解码器中已就绪的帧，没有可取的帧时才送入新的数据包
+    int ret = avcodec_receive_frame(m_audioCodecContext, m_audioFrame);
+    if (ret == AVERROR(EAGAIN)) {
+        return sendNextPacket();
+    }
+    if (ret == AVERROR_EOF) {
+        // 解码器冲刷完成，再冲刷过滤器，atempo 内部缓存的最后一段样本也要输出
+        if (m_tempoGraph.graph && !m_tempoGraph.eof) {
+            av_buffersrc_add_frame_flags(m_tempoGraph.source, nullptr, 0);
+            m_tempoGraph.eof = true;
+            drainFilter();
+            // 结束后的图不能沿用，趁播放到末尾时备好跳转用的新图
+            if (!m_spareGraph.graph) {
+                buildTempoGraph(m_spareGraph);
+            }
+        }
+        return false;
+    }
+    if (ret < 0) {
+        qDebug() << "Failed to receive audio frame:" << ret;
+        return sendNextPacket();
+    }
+
+    // 跳转目标在送入过滤器之前按原始采样率截断，与倍速无关
+    if (trimToSeekTarget(m_audioFrame)) {
+        if (m_tempoGraph.graph) {
+            filterFrame(m_audioFrame);
+        } else {
+            qint64 timestamp = m_audioFrame->pts != AV_NOPTS_VALUE
+                    ? av_rescale_q(m_audioFrame->pts, m_audioStream->time_base, AVRational{1, 1000}) : 0;
+            pushFrame(m_audioFrame, timestamp, 1.0f);
+        }
+    }
+    av_frame_unref(m_audioFrame);
+
+    return true;
+}
+
+bool AudioCode::trimToSeekTarget(AVFrame *frame)
+{
+    if (m_seekTargetMs < 0) {
+        return true;
+    }
+    if (frame->pts == AV_NOPTS_VALUE) {
+        // 没有时间戳无法判断位置，放弃精确跳转
+        m_seekTargetMs = -1;
+        return true;
+    }
+    int sampleRate = m_audioCodecContext->sample_rate;
+    int64_t startSample = av_rescale_q(frame->pts, m_audioStream->time_base, AVRational{1, sampleRate});
+    int64_t targetSample = av_rescale(m_seekTargetMs, sampleRate, 1000);
+    if (startSample + frame->nb_samples <= targetSample) {
+        return false;
+    }
+    // 跨越目标的一帧把目标之后的样本移到开头；解码器输出的帧可能被共享，先确保可写
+    if (targetSample > startSample && av_frame_make_writable(frame) >= 0) {
+        int skipSamples = static_cast<int>(targetSample - startSample);
+        av_samples_copy(frame->extended_data, frame->extended_data, 0, skipSamples,
+                        frame->nb_samples - skipSamples, frame->ch_layout.nb_channels,
+                        static_cast<AVSampleFormat>(frame->format));
+        frame->nb_samples -= skipSamples;
+        frame->pts += av_rescale_q(skipSamples, AVRational{1, sampleRate}, m_audioStream->time_base);
+    }
+    m_seekTargetMs = -1;
+    return true;
+}
+
+void AudioCode::filterFrame(AVFrame *frame)
+{
+    applyTempo();
+    // abuffer 的时间基是 1/采样率，送入前转换 pts
+    if (frame->pts != AV_NOPTS_VALUE) {
+        frame->pts = av_rescale_q(frame->pts, m_audioStream->time_base,
+                                  AVRational{1, m_audioCodecContext->sample_rate});
+        if (m_filterStartPts == AV_NOPTS_VALUE) {
+            m_filterStartPts = frame->pts;
+            m_filterMediaSamples = 0.0;
+            m_filterInputSamples = 0;
+        } else {
+            int64_t expectedPts = m_filterStartPts + m_filterInputSamples;
+            int64_t tolerance = av_rescale(AUDIO_PTS_RESYNC_MS, m_audioCodecContext->sample_rate, 1000);
+            if (qAbs(frame->pts - expectedPts) > tolerance) {
+                // 输入不连续（丢包、时间戳跳变）：平移起点重新对齐，
+                // 过滤器中尚未输出的旧样本随之平移，误差不超过 atempo 的缓存时长
+                m_filterStartPts += frame->pts - expectedPts;
             }
         }
-        av_packet_unref(m_packet);
     }
+    // 过滤器取走帧后会重置它，先累计送入的样本数
+    m_filterInputSamples += frame->nb_samples;
+    // 将原始帧添加到过滤器输入，所有权转交给过滤器
+    if (av_buffersrc_add_frame_flags(m_tempoGraph.source, frame, 0) >= 0) {
+        // 一个输入帧可能产生零个或多个输出帧，全部取出
+        drainFilter();
+    }
+}
 
-    return false; // 文件结束
+void AudioCode::applyTempo()
+{
+    float speed = m_requestedSpeed.load(std::memory_order_relaxed);
+    if (speed == m_appliedSpeed) {
+        return;
+    }
+    // 倍速拆分到各级：前面的级先取到 0.5 或 2.0，余下的交给后面的级
+    double remaining = speed;
+    for (int i = 0; i < AUDIO_TEMPO_STAGES; ++i) {
+        double tempo = qBound(0.5, remaining, 2.0);
+        remaining /= tempo;
+        char target[16];
+        snprintf(target, sizeof(target), "atempo%d", i);
+        // 不使用 snprintf("%f")：它随 C 区域设置可能输出逗号小数点，atempo 无法解析
+        QByteArray arg = QByteArray::number(tempo, 'f', 6);
+        int ret = avfilter_graph_send_command(m_tempoGraph.graph, target, "tempo", arg.constData(), nullptr, 0, 0);
+        if (ret < 0) {
+            qDebug() << "Failed to set tempo of" << target << "to" << tempo << ":" << ret;
+        }
+    }
+    m_appliedSpeed = speed;
+}
+
+bool AudioCode::sendNextPacket()
+{
+    if (!m_pendingPacket) {
+        if (m_flushSent) {
+            return false;
+        }
+        int serial = 0;
+        if (!m_packetQueue->pop(m_pendingPacket, &serial)) {
+            if (m_demuxer->isEof() && m_packetQueue->empty()) {
+                // 文件结束：送入空包进入冲刷模式，之后 receive 依次返回缓存的帧和 EOF
+                avcodec_send_packet(m_audioCodecContext, nullptr);
+                m_flushSent = true;
+                return true;
+            }
+            // 包队列为空，挂起等待下一个包
+            m_packetQueue->waitPop(m_pendingPacket, AUDIO_DECODE_WAIT_TIMEOUT_MS, &serial);
+            if (!m_pendingPacket) {
+                return true;
+            }
+        }
+        if (serial > m_serial) {
+            // 解复用器先发布序号再入队，新跳转的数据包可能先于 syncSerial() 被取到：
+            // 先切换到新序号（冲刷会释放 m_pendingPacket，先取下），再送入该包
+            AVPacket *packet = m_pendingPacket;
+            m_pendingPacket = nullptr;
+            syncSerial();
+            m_pendingPacket = packet;
+        }
+        if (serial != m_serial) {
+            // 跳转前读到的旧数据包（或已被更新的跳转取代），不送入解码器
+            av_packet_free(&m_pendingPacket);
+            return true;
+        }
+    }
+
+    int ret = avcodec_send_packet(m_audioCodecContext, m_pendingPacket);
+    if (ret == AVERROR(EAGAIN)) {
+        // 解码器输入已满，保留该包，下一轮先取出输出帧
+        return true;
+    }
+    if (ret < 0) {
+        qDebug() << "Failed to send audio packet:" << ret;
+    }
+    av_packet_free(&m_pendingPacket);
+    return true;
+}
+
+void AudioCode::drainFilter()
+{
+    int sampleRate = av_buffersink_get_sample_rate(m_tempoGraph.sink);
+    while (av_buffersink_get_frame(m_tempoGraph.sink, m_filteredFrame) >= 0) {
+        if (m_filterDiscardSamples > 0.0 && !discardFilterResidue(m_filteredFrame)) {
+            av_frame_unref(m_filteredFrame);
+            continue;
+        }
+        qint64 timestamp = 0;
+        if (m_filterStartPts != AV_NOPTS_VALUE) {
+            timestamp = av_rescale(m_filterStartPts, 1000, m_audioCodecContext->sample_rate)
+                    + static_cast<qint64>(m_filterMediaSamples * 1000 / sampleRate);
+        }
+        // 倍速改变后过滤器中缓存的样本按新倍速输出，按输出时的倍速累计媒体时间
+        m_filterMediaSamples += m_filteredFrame->nb_samples * static_cast<double>(m_appliedSpeed);
+        pushFrame(m_filteredFrame, timestamp, m_appliedSpeed);
+        av_frame_unref(m_filteredFrame);
+    }
+}
+
+bool AudioCode::discardFilterResidue(AVFrame *frame)
+{
+    // 输出的每个样本消耗 倍速 个媒体样本，残留部分按输出时的倍速换算
+    double frameMediaSamples = frame->nb_samples * static_cast<double>(m_appliedSpeed);
+    if (frameMediaSamples <= m_filterDiscardSamples) {
+        m_filterDiscardSamples -= frameMediaSamples;
+        return false;
+    }
+    int skipSamples = static_cast<int>(m_filterDiscardSamples / m_appliedSpeed);
+    m_filterDiscardSamples = 0.0;
+    // 残留与新位置衔接的一帧只保留新位置的部分，与 trimToSeekTarget() 相同的截断方式
+    if (skipSamples > 0 && av_frame_make_writable(frame) >= 0) {
+        av_samples_copy(frame->extended_data, frame->extended_data, 0, skipSamples,
+                        frame->nb_samples - skipSamples, frame->ch_layout.nb_channels,
+                        static_cast<AVSampleFormat>(frame->format));
+        frame->nb_samples -= skipSamples;
+    }
+    return frame->nb_samples > 0;
+}
+
+void AudioCode::pushFrame(AVFrame *frame, qint64 timestamp, float speed)
+{
+    // 重采样音频 - 单声道
+    int outSamples = av_rescale_rnd(frame->nb_samples, 44100, m_audioCodecContext->sample_rate, AV_ROUND_UP);
+    int outBufferSize = av_samples_get_buffer_size(nullptr, 1, outSamples, AV_SAMPLE_FMT_S16, 1);
+
+    if (m_audioBufferSize < outBufferSize) {
+        av_free(m_audioBuffer);
+        m_audioBuffer = (uint8_t*)av_malloc(outBufferSize);
+        m_audioBufferSize = outBufferSize;
+    }
+
+    uint8_t *outData[1] = {m_audioBuffer};
+    int outSamplesActual = swr_convert(m_swrContext, outData, outSamples,
+                                     (const uint8_t**)frame->data, frame->nb_samples);
+    if (outSamplesActual <= 0) {
+        return;
+    }
+
+    if (m_fadeInPos >= 0) {
+        // 跳转后输出流从静音开始，新位置的开头线性淡入
+        int16_t *samples = reinterpret_cast<int16_t*>(m_audioBuffer);
+        const int fadeSamples = 44100 * AUDIO_FADE_IN_MS / 1000;
+        for (int i = 0; i < outSamplesActual && m_fadeInPos < fadeSamples; ++i, ++m_fadeInPos) {
+            samples[i] = static_cast<int16_t>(samples[i] * m_fadeInPos / fadeSamples);
+        }
+        if (m_fadeInPos >= fadeSamples) {
+            m_fadeInPos = -1;
+        }
+    }
+
+    // 单声道：样本数 × 1通道 × 2字节/样本
+    AudioData audioData;
+    audioData.audioData = QByteArray((const char*)m_audioBuffer, outSamplesActual * 1 * 2);
+    audioData.timestamp = timestamp;
+    audioData.serial = m_serial;
+    audioData.speed = speed;
+
+    qint64 bytes = audioData.audioData.size();
+    // 过滤器冲刷时一次会输出多帧，队列满时挂起等待而不是丢弃；期间发生跳转则放弃旧数据
+    while (!m_audioDataQueue.waitPush(std::move(audioData), AUDIO_DECODE_WAIT_TIMEOUT_MS)) {
+        if (m_playerState->quitRequested() || m_audioDataQueue.isClosed() || m_demuxer->getSerial() != m_serial) {
+            return;
+        }
+    }
+    m_decodeBudget.onPush(bytes, timestamp);
 }
 
 void AudioCode::run()
 {
     qDebug() << "AudioCode run";
-    setPlaying(true);
-    while (true) {
-        if (!m_isOpened) {
-            break;
-        }
-        if (!isPlaying()) {
-            break;
+    while (m_isOpened && !m_playerState->quitRequested()) {
+        if (!m_playerState->isActive()) {
+            // 暂停或播放结束：挂起到状态变化，不退出线程
+            m_playerState->waitActive(WaitEvent::toTimeoutUs(AUDIO_DECODE_WAIT_TIMEOUT_MS));
+            continue;
         }
-        if (m_audioDataQueue.size() >= MAX_AUDIO_BUFFER_SIZE) {
-            msleep(1);
+        // 按内存和时长预算限流，而不是按数据块个数
+        if (m_audioDataQueue.full() || m_decodeBudget.isOverBudget(m_audioDataQueue.size())) {
+            // 数据已足够，趁空闲补建跳转时换下的备用过滤器图
+            if (m_tempoGraph.graph && !m_spareGraph.graph) {
+                buildTempoGraph(m_spareGraph);
+            }
+            // 挂起到消费者取走数据为止
+            m_audioDataQueue.waitForPop(AUDIO_DECODE_WAIT_TIMEOUT_MS);
             continue;
         }
         if (!getNextFrame()) {
-            break;
+            // 已解码到文件末尾，挂起等待跳转后的新数据包
+            m_drainedSerial.store(m_serial, std::memory_order_release);
+            m_packetQueue->waitForData(AUDIO_DECODE_WAIT_TIMEOUT_MS);
         }
     }
     qDebug() << "AudioCode run end";
-    // 注意：暂停时不要closeAudio，只有停止时才关闭
+    // 注意：暂停时线程挂起而不退出，只有关闭文件时才退出
 }
 
 void AudioCode::closeAudio()
@@ -291,12 +500,8 @@ void AudioCode::closeAudio()
 void AudioCode::cleanup()
 {
     // 释放过滤器资源
-    if (m_filterGraph) {
-        avfilter_graph_free(&m_filterGraph);
-        m_filterGraph = nullptr;
-        m_buffersrcCtx = nullptr;
-        m_buffersinkCtx = nullptr;
-    }
+    freeTempoGraph(m_tempoGraph);
+    freeTempoGraph(m_spareGraph);
     
     if (m_swrContext) {
         swr_free(&m_swrContext);
@@ -307,57 +512,44 @@ void AudioCode::cleanup()
         m_audioBuffer = nullptr;
     }
     
-    if (m_packet) {
-        av_packet_free(&m_packet);
-    }
-    
     if (m_audioFrame) {
         av_frame_free(&m_audioFrame);
     }
+
+    if (m_filteredFrame) {
+        av_frame_free(&m_filteredFrame);
+    }
+
+    if (m_pendingPacket) {
+        av_packet_free(&m_pendingPacket);
+    }
+    m_flushSent = false;
     
     if (m_audioCodecContext) {
         avcodec_free_context(&m_audioCodecContext);
     }
     
-    if (m_formatContext) {
-        avformat_close_input(&m_formatContext);
-    }
-    
+    m_demuxer = nullptr;
+    m_packetQueue = nullptr;
+    m_audioStream = nullptr;
     m_audioBufferSize = 0;
 }
 
-bool AudioCode::initAudioFilter(float speed)
+void AudioCode::freeTempoGraph(TempoGraph &tempoGraph)
 {
-    // 限制速度范围：atempo 过滤器支持 0.5 到 2.0
-    if (speed < 0.5f || speed > 2.0f) {
-        qDebug() << "Speed must be between 0.5 and 2.0, clamping:" << speed;
-        speed = qBound(0.5f, speed, 2.0f);
+    if (tempoGraph.graph) {
+        avfilter_graph_free(&tempoGraph.graph);
     }
-    
-    m_playbackSpeed = speed;
-    
-    // 如果速度是1.0，不需要过滤器
-    if (qAbs(speed - 1.0f) < 0.01f) {
-        if (m_filterGraph) {
-            avfilter_graph_free(&m_filterGraph);
-            m_filterGraph = nullptr;
-            m_buffersrcCtx = nullptr;
-            m_buffersinkCtx = nullptr;
-        }
-        return true;
-    }
-    
-    // 清理旧的过滤器
-    if (m_filterGraph) {
-        avfilter_graph_free(&m_filterGraph);
-        m_filterGraph = nullptr;
-        m_buffersrcCtx = nullptr;
-        m_buffersinkCtx = nullptr;
-    }
-    
+    tempoGraph = TempoGraph();
+}
+
+bool AudioCode::buildTempoGraph(TempoGraph &tempoGraph)
+{
+    freeTempoGraph(tempoGraph);
+
     // 创建过滤器图
-    m_filterGraph = avfilter_graph_alloc();
-    if (!m_filterGraph) {
+    AVFilterGraph *graph = avfilter_graph_alloc();
+    if (!graph) {
         qDebug() << "Failed to allocate filter graph";
         return false;
     }
@@ -369,7 +561,7 @@ bool AudioCode::initAudioFilter(float speed)
     
     if (!buffersrc || !buffersink || !atempo) {
         qDebug() << "Failed to get filters";
-        avfilter_graph_free(&m_filterGraph);
+        avfilter_graph_free(&graph);
         return false;
     }
     
@@ -417,79 +609,82 @@ bool AudioCode::initAudioFilter(float speed)
                  ch_layout.nb_channels);
     }
     
-    int ret = avfilter_graph_create_filter(&m_buffersrcCtx, buffersrc, "in",
-                                           args, nullptr, m_filterGraph);
+    AVFilterContext *source = nullptr;
+    int ret = avfilter_graph_create_filter(&source, buffersrc, "in",
+                                           args, nullptr, graph);
     if (ret < 0) {
         char errbuf[AV_ERROR_MAX_STRING_SIZE];
         av_strerror(ret, errbuf, AV_ERROR_MAX_STRING_SIZE);
         qDebug() << "Failed to create buffer source:" << errbuf;
-        avfilter_graph_free(&m_filterGraph);
+        avfilter_graph_free(&graph);
         return false;
     }
     
-    // 创建 atempo 过滤器
-    snprintf(args, sizeof(args), "tempo=%.2f", speed);
-    AVFilterContext *atempoCtx = nullptr;
-    ret = avfilter_graph_create_filter(&atempoCtx, atempo, "atempo",
-                                       args, nullptr, m_filterGraph);
-    if (ret < 0) {
-        char errbuf[AV_ERROR_MAX_STRING_SIZE];
-        av_strerror(ret, errbuf, AV_ERROR_MAX_STRING_SIZE);
-        qDebug() << "Failed to create atempo filter:" << errbuf;
-        avfilter_graph_free(&m_filterGraph);
-        return false;
+    // 串联 atempo：每级只在 0.5~2.0 之间工作，两级覆盖 0.25~4.0；倍速之后通过命令修改
+    AVFilterContext *previous = source;
+    for (int i = 0; i < AUDIO_TEMPO_STAGES; ++i) {
+        char name[16];
+        snprintf(name, sizeof(name), "atempo%d", i);
+        AVFilterContext *atempoCtx = nullptr;
+        ret = avfilter_graph_create_filter(&atempoCtx, atempo, name,
+                                           "tempo=1.0", nullptr, graph);
+        if (ret < 0) {
+            char errbuf[AV_ERROR_MAX_STRING_SIZE];
+            av_strerror(ret, errbuf, AV_ERROR_MAX_STRING_SIZE);
+            qDebug() << "Failed to create atempo filter:" << errbuf;
+            avfilter_graph_free(&graph);
+            return false;
+        }
+        ret = avfilter_link(previous, 0, atempoCtx, 0);
+        if (ret < 0) {
+            qDebug() << "Failed to link" << name;
+            avfilter_graph_free(&graph);
+            return false;
+        }
+        previous = atempoCtx;
     }
     
     // 创建输出过滤器上下文 (abuffersink)
-    ret = avfilter_graph_create_filter(&m_buffersinkCtx, buffersink, "out",
-                                       nullptr, nullptr, m_filterGraph);
+    AVFilterContext *sink = nullptr;
+    ret = avfilter_graph_create_filter(&sink, buffersink, "out",
+                                       nullptr, nullptr, graph);
     if (ret < 0) {
         char errbuf[AV_ERROR_MAX_STRING_SIZE];
         av_strerror(ret, errbuf, AV_ERROR_MAX_STRING_SIZE);
         qDebug() << "Failed to create buffer sink:" << errbuf;
-        avfilter_graph_free(&m_filterGraph);
-        return false;
-    }
-    
-    // 连接过滤器: abuffer -> atempo -> abuffersink
-    ret = avfilter_link(m_buffersrcCtx, 0, atempoCtx, 0);
-    if (ret < 0) {
-        qDebug() << "Failed to link buffersrc to atempo";
-        avfilter_graph_free(&m_filterGraph);
+        avfilter_graph_free(&graph);
         return false;
     }
     
-    ret = avfilter_link(atempoCtx, 0, m_buffersinkCtx, 0);
+    ret = avfilter_link(previous, 0, sink, 0);
     if (ret < 0) {
         qDebug() << "Failed to link atempo to buffersink";
-        avfilter_graph_free(&m_filterGraph);
+        avfilter_graph_free(&graph);
         return false;
     }
     
     // 配置过滤器图
-    ret = avfilter_graph_config(m_filterGraph, nullptr);
+    ret = avfilter_graph_config(graph, nullptr);
     if (ret < 0) {
         char errbuf[AV_ERROR_MAX_STRING_SIZE];
         av_strerror(ret, errbuf, AV_ERROR_MAX_STRING_SIZE);
         qDebug() << "Failed to configure filter graph:" << errbuf;
-        avfilter_graph_free(&m_filterGraph);
+        avfilter_graph_free(&graph);
         return false;
     }
     
+    tempoGraph.graph = graph;
+    tempoGraph.source = source;
+    tempoGraph.sink = sink;
     return true;
 }
 
 void AudioCode::setPlaybackSpeed(float speed)
 {
-    QMutexLocker locker(&m_mutex);
-    
-    if (!m_isOpened) {
-        m_playbackSpeed = speed;
-        return;
-    }
-    
-    // 重新初始化过滤器
-    if (!initAudioFilter(speed)) {
-        qDebug() << "Failed to set playback speed to:" << speed;
+    if (speed < AUDIO_TEMPO_MIN || speed > AUDIO_TEMPO_MAX) {
+        qDebug() << "Speed must be between" << AUDIO_TEMPO_MIN << "and" << AUDIO_TEMPO_MAX << ", clamping:" << speed;
+        speed = qBound(AUDIO_TEMPO_MIN, speed, AUDIO_TEMPO_MAX);
     }
+    // 解码线程送入下一帧之前应用，不与解码线程争用过滤器
+    m_requestedSpeed.store(speed);
 }
@@ -4,8 +4,11 @@
 #include <QObject>
 #include <QByteArray>
 #include <QThread>
-#include <QMutex>
+#include <atomic>
 #include "../models/SPSCLockFreeQueue.h"
+#include "../models/DecodeBudget.h"
+#include "../models/PlayerState.h"
+#include "Demuxer.h"
 
 extern "C" {
 #include <libavformat/avformat.h>
@@ -17,17 +20,32 @@ extern "C" {
 #include <libavfilter/buffersink.h>
 }
 
-#define MAX_AUDIO_BUFFER_SIZE 128
+#define MAX_AUDIO_BUFFER_SIZE 128 // 队列槽位数，仅作为硬上限
+#define AUDIO_DECODE_AHEAD_BYTES (1024 * 1024) // 预解码内存预算 1MB
+#define AUDIO_DECODE_AHEAD_MS 500 // 预解码时长预算 500ms
+#define AUDIO_DECODE_WAIT_TIMEOUT_MS 100 // 队列空/超出预算时单次等待的最长时间
+#define AUDIO_TEMPO_MIN 0.25f // 变速播放的倍速下限
+#define AUDIO_TEMPO_MAX 4.0f // 变速播放的倍速上限
+#define AUDIO_TEMPO_STAGES 2 // 串联的 atempo 级数，每级只在 0.5~2.0 之间工作，音质最好
+#define AUDIO_PTS_RESYNC_MS 20 // 输入帧时间戳与累计样本位置相差超过该时长时重新对齐输出时间戳
+#define AUDIO_FADE_IN_MS 5 // 跳转后新位置的音频淡入时长，避免从静音突然起音产生爆音
 
 struct AudioData
 {
     QByteArray audioData;
     qint64 timestamp;
+    // 解码该段数据时的跳转序号，渲染线程丢弃不属于最新跳转请求的数据
+    int serial;
+    // 该段数据的倍速，即每秒 PCM 对应的媒体时长；倍速改变时已解码的数据仍按原倍速计时
+    float speed;
 
     // 默认构造函数
-    AudioData() : audioData(QByteArray()), timestamp(-1) {}
+    AudioData() : audioData(QByteArray()), timestamp(-1), serial(0), speed(1.0f) {}
 };
 
+// 阻塞模式队列：队列空/满时挂起线程而不是轮询
+typedef SPSCLockFreeQueue<AudioData, MAX_AUDIO_BUFFER_SIZE, true> AudioDataQueue;
+
 class AudioCode : public QThread
 {
     Q_OBJECT
@@ -36,54 +54,125 @@ public:
     explicit AudioCode(QObject *parent = nullptr);
     ~AudioCode();
 
-    bool openAudio(const QString &filePath);
+    // 从解复用器的音频包队列解码，文件由 Demuxer 统一打开
+    bool openAudio(Demuxer *demuxer);
     void closeAudio();
+    // 解码状态机推进一步：取出一帧已解码的帧（经过滤器时取出所有输出），或送入一个数据包；
+    // 解码器和过滤器都冲刷完毕返回 false
     bool getNextFrame();
 
-    void setPlaying(bool isPlaying);
-    bool isPlaying();
-
-    // 跳转到指定时间，单位为秒
-    void seekTo(int seconds);
-
-    // 设置播放速度倍率 (0.5-2.0)
+    // 设置共享的播放器状态（不持有），start() 之前调用
+    void setPlayerState(PlayerState *playerState) { m_playerState = playerState; }
+    // 唤醒挂起在输入/输出队列上的解码线程，让它重新检查状态
+    void wakeUp();
+    // 已解码到文件末尾时的跳转序号，与最新跳转序号相同表示该位置之后的数据已全部输出
+    int getDrainedSerial() const { return m_drainedSerial.load(std::memory_order_acquire); }
+
+
+    // 设置预解码预算，<= 0 表示对应项不限制
+    void setDecodeAheadLimit(qint64 maxBytes, qint64 maxAheadMs);
+    // 已解码未播放的字节数和时长（解码线程最近一次检查预算时的值，任意线程可调用）
+    qint64 getQueuedBytes() const { return m_decodeBudget.publishedBytes(); }
+    qint64 getQueuedDurationMs() const { return m_decodeBudget.publishedDurationMs(); }
+
+    /**
+     * @brief 设置播放速度倍率（AUDIO_TEMPO_MIN~AUDIO_TEMPO_MAX），任意线程调用，不阻塞
+     *
+     * 只记录倍速，由解码线程在送入下一帧之前通过 avfilter_graph_send_command 修改各级 atempo，
+     * 过滤器图不重建，缓存中的样本不丢失；atempo 按重叠相加（WSOLA）衔接前后两段，没有断点。
+     */
     void setPlaybackSpeed(float speed);
-    float getPlaybackSpeed() const { return m_playbackSpeed; }
+    float getPlaybackSpeed() const { return m_requestedSpeed.load(); }
 
-    SPSCLockFreeQueue<AudioData, MAX_AUDIO_BUFFER_SIZE> &getAudioDataQueue() { return m_audioDataQueue; }
+    AudioDataQueue &getAudioDataQueue() { return m_audioDataQueue; }
 
 private:
     void run() override;
     void cleanup();
-    bool initAudioFilter(float speed);
+
+    // abuffer -> atempo0 -> ... -> abuffersink，各级 atempo 初始倍速为 1.0
+    struct TempoGraph
+    {
+        AVFilterGraph *graph;
+        AVFilterContext *source;
+        AVFilterContext *sink;
+        // 已送入结束标记，之后不能再接收帧
+        bool eof;
+
+        TempoGraph() : graph(nullptr), source(nullptr), sink(nullptr), eof(false) {}
+    };
+    bool buildTempoGraph(TempoGraph &tempoGraph);
+    static void freeTempoGraph(TempoGraph &tempoGraph);
+    // 把请求的倍速拆分到各级 atempo 并发送命令（仅由解码线程调用）
+    void applyTempo();
+    // 跳转后按样本精确丢弃目标之前的数据，返回 false 表示整帧都在目标之前
+    bool trimToSeekTarget(AVFrame *frame);
+    // 解码帧送入过滤器并取出输出
+    void filterFrame(AVFrame *frame);
+    // 解复用器完成跳转后冲刷解码器和过滤器，并取得跳转目标（仅由解码线程调用）
+    void syncSerial();
+    // 清空解码器、过滤器缓冲区；已输出的旧数据由渲染线程按序号丢弃
+    void flush();
+    // 送入下一个数据包，文件结束时送入空包冲刷解码器；丢弃跳转前的旧数据包
+    bool sendNextPacket();
+    // 取出过滤器中所有可用的输出帧
+    void drainFilter();
+    // 丢弃沿用旧图时残留的旧位置样本，返回 false 表示整帧都是残留
+    bool discardFilterResidue(AVFrame *frame);
+    // 重采样并输出一帧，timestamp 为该帧第一个样本的媒体时间（毫秒），speed 为该帧的倍速
+    void pushFrame(AVFrame *frame, qint64 timestamp, float speed);
     
+    // 解复用器（不持有）
+    Demuxer *m_demuxer;
+    PacketQueue *m_packetQueue;
+
     // FFmpeg核心变量
-    AVFormatContext *m_formatContext;
     AVCodecContext *m_audioCodecContext;
     SwrContext *m_swrContext;
     
-    int m_audioStreamIndex;
-    
-    AVPacket *m_packet;
     AVFrame *m_audioFrame;
+    // 过滤器输出帧，复用同一个 AVFrame
+    AVFrame *m_filteredFrame;
     AVStream *m_audioStream;
+    // 解码器暂不接收（EAGAIN）而保留的数据包
+    AVPacket *m_pendingPacket;
+    // 是否已送入冲刷用的空包
+    bool m_flushSent;
+    // 当前解码数据所属的跳转序号和跳转目标（毫秒）：目标之前的样本在送入过滤器之前丢弃，
+    // 跨越目标的一帧从目标处截断，目标为 -1 表示已到达或没有跳转
+    int m_serial;
+    qint64 m_seekTargetMs;
     
     uint8_t *m_audioBuffer;
     int m_audioBufferSize;
     
-    // 音频过滤器相关
-    AVFilterGraph *m_filterGraph;
-    AVFilterContext *m_buffersrcCtx;
-    AVFilterContext *m_buffersinkCtx;
-    float m_playbackSpeed;
+    // 变速过滤器：正在使用的图和预先建好的备用图，跳转时直接换上备用图，不在跳转路径上重建；
+    // 备用图尚未补建时沿用旧图，丢弃其中残留的旧位置样本
+    TempoGraph m_tempoGraph;
+    TempoGraph m_spareGraph;
+    // 请求的倍速（任意线程写入）和当前过滤器使用的倍速（仅解码线程访问）
+    std::atomic<float> m_requestedSpeed;
+    float m_appliedSpeed;
+    // atempo 输出帧的 pts 按输出样本数递增，不是媒体时间；
+    // 自行记录送入过滤器的第一个样本的 pts（1/采样率），并按各段输出时的倍速累计已消耗的媒体样本数；
+    // 同时累计送入的样本数，输入时间戳与累计位置不符时平移起点
+    int64_t m_filterStartPts;
+    double m_filterMediaSamples;
+    int64_t m_filterInputSamples;
+    // 沿用旧图时旧位置残留在过滤器中、尚未输出的媒体样本数，这部分输出直接丢弃
+    double m_filterDiscardSamples;
+    // 跳转后已淡入的输出样本数，-1 表示不需要淡入
+    int m_fadeInPos;
     
     bool m_isOpened;
 
-    // 播放状态
-    bool m_isPlaying;
-    QMutex m_mutex;
+    // 播放器状态（不持有），暂停时挂起，要求退出时结束 run()
+    PlayerState *m_playerState;
+    std::atomic<int> m_drainedSerial;
 
-    SPSCLockFreeQueue<AudioData, MAX_AUDIO_BUFFER_SIZE> m_audioDataQueue;
+    AudioDataQueue m_audioDataQueue;
+    // 预解码预算，由解码线程（生产者）维护
+    DecodeBudget<MAX_AUDIO_BUFFER_SIZE> m_decodeBudget;
 };
 
 #endif // AUDIOCODE_H
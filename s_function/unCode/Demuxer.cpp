@@ -0,0 +1,438 @@
+#include "Demuxer.h"
+#include <QDebug>
+
+Demuxer::Demuxer(QObject *parent)
+    : QThread(parent)
+    , m_formatContext(nullptr)
+    , m_videoStreamIndex(-1)
+    , m_audioStreamIndex(-1)
+    , m_pendingPacket(nullptr)
+    , m_isOpened(false)
+    , m_isEof(false)
+    , m_playerState(nullptr)
+    , m_requestedMs(0)
+    , m_serial(0)
+    , m_seekTargetMs(-1)
+    , m_requestedTrickRate(0)
+    , m_trickRate(0)
+    , m_trickLastMs(-1)
+    , m_videoPacketQueue(MAX_VIDEO_PACKET_BYTES)
+    , m_audioPacketQueue(MAX_AUDIO_PACKET_BYTES)
+    , m_keyframeScanner(new KeyframeScanner(this))
+    , m_keyframeScanEnabled(false)
+    , m_readContinuous(true)
+{
+
+}
+
+Demuxer::~Demuxer()
+{
+    // 先停止线程并等待结束，避免 "Destroyed while thread is still running" 错误
+    if (isRunning()) {
+        m_playerState->requestQuit();
+        wakeUp();
+        wait();
+    }
+    closeFile();
+}
+
+void Demuxer::wakeUp()
+{
+    m_wakeEvent.wake();
+    m_videoPacketQueue.notifyAll();
+    m_audioPacketQueue.notifyAll();
+}
+
+int Demuxer::getDuration() const
+{
+    if (!m_formatContext || m_formatContext->duration == AV_NOPTS_VALUE) {
+        return 0;
+    }
+    // duration 单位是 AV_TIME_BASE (通常是微秒)
+    return static_cast<int>(m_formatContext->duration / AV_TIME_BASE);
+}
+
+AVStream *Demuxer::getVideoStream() const
+{
+    if (!m_formatContext || m_videoStreamIndex < 0) {
+        return nullptr;
+    }
+    return m_formatContext->streams[m_videoStreamIndex];
+}
+
+AVStream *Demuxer::getAudioStream() const
+{
+    if (!m_formatContext || m_audioStreamIndex < 0) {
+        return nullptr;
+    }
+    return m_formatContext->streams[m_audioStreamIndex];
+}
+
+bool Demuxer::openFile(const QString &filePath)
+{
+    closeFile(); // 先清理之前的资源
+
+    // 打开文件，整个播放器只探测一次
+    if (avformat_open_input(&m_formatContext, filePath.toUtf8().constData(), nullptr, nullptr) < 0) {
+        qDebug() << "Failed to open media file:" << filePath;
+        return false;
+    }
+
+    if (avformat_find_stream_info(m_formatContext, nullptr) < 0) {
+        qDebug() << "Failed to find stream info";
+        cleanup();
+        return false;
+    }
+
+    m_videoStreamIndex = av_find_best_stream(m_formatContext, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    m_audioStreamIndex = av_find_best_stream(m_formatContext, AVMEDIA_TYPE_AUDIO, -1, -1, nullptr, 0);
+    if (m_videoStreamIndex < 0 && m_audioStreamIndex < 0) {
+        qDebug() << "No audio or video stream found";
+        cleanup();
+        return false;
+    }
+
+    // 丢弃不需要的流，减少解复用器的工作量
+    for (unsigned int i = 0; i < m_formatContext->nb_streams; ++i) {
+        if (static_cast<int>(i) != m_videoStreamIndex && static_cast<int>(i) != m_audioStreamIndex) {
+            m_formatContext->streams[i]->discard = AVDISCARD_ALL;
+        }
+    }
+
+    m_isEof.store(false, std::memory_order_release);
+    m_isOpened = true;
+    m_readContinuous = true;
+    // 新文件从头播放，丢弃上一个文件尚未执行的跳转请求
+    m_seekTargetMs.store(-1, std::memory_order_release);
+    m_requestedTrickRate.store(0, std::memory_order_release);
+    m_trickRate.store(0, std::memory_order_release);
+    m_trickLastMs = -1;
+    m_serial.store(getRequestedSerial(), std::memory_order_release);
+    m_filePath = filePath;
+
+    // 有完整的索引缓存时直接使用；否则先取容器自带的索引，它在探测时已经读入，不需要额外 IO。
+    // 容器没有完整索引时逐包扫描要把文件再读一遍，只在启用扫描且文件位于本地磁盘时进行；
+    // 播放读到的关键帧同样计入索引
+    if (m_videoStreamIndex >= 0 && !m_keyframeIndex.load(filePath)) {
+        if (KeyframeScanner::readContainerIndex(m_formatContext, m_videoStreamIndex, &m_keyframeIndex)) {
+            m_keyframeIndex.setComplete(true);
+        } else if (m_keyframeScanEnabled && KeyframeScanner::isLocalFile(filePath)) {
+            m_keyframeScanner->startScan(filePath, &m_keyframeIndex);
+        }
+    }
+    qDebug() << "Demuxer opened, video stream:" << m_videoStreamIndex << "audio stream:" << m_audioStreamIndex;
+    return true;
+}
+
+void Demuxer::closeFile()
+{
+    cleanup();
+    m_isOpened = false;
+}
+
+int Demuxer::requestSeek(qint64 positionMs, int trickRate)
+{
+    // 先写目标和倍率再递增序号，解复用线程读到新序号时一定能读到不早于它的目标
+    m_requestedMs.store(positionMs, std::memory_order_release);
+    m_requestedTrickRate.store(trickRate, std::memory_order_release);
+    int serial = m_playerState->beginSeek();
+    // 唤醒在文件末尾等待或因包队列已满挂起的解复用线程
+    wakeUp();
+    return serial;
+}
+
+void Demuxer::applyPendingSeek()
+{
+    // 执行期间到达的新请求留到下一轮，中间被取代的请求不会执行
+    int serial = getRequestedSerial();
+    qint64 positionMs = m_requestedMs.load(std::memory_order_acquire);
+    int trickRate = m_requestedTrickRate.load(std::memory_order_acquire);
+    if (!seekTo(positionMs)) {
+        // 跳转失败也要丢弃旧位置读到的数据包并清除 EOF，否则旧包会带着新序号入队，
+        // 或在文件末尾失败后继续挂起；丢包后读取不再连续，不能继续补全索引
+        m_readContinuous = false;
+        if (m_pendingPacket) {
+            av_packet_free(&m_pendingPacket);
+        }
+        m_isEof.store(false, std::memory_order_release);
+    }
+
+    // 快进/快退时只需要视频关键帧：音频流整个丢弃，支持的解复用器直接跳过非关键帧数据
+    if (m_audioStreamIndex >= 0) {
+        m_formatContext->streams[m_audioStreamIndex]->discard = trickRate != 0 ? AVDISCARD_ALL : AVDISCARD_DEFAULT;
+    }
+    if (m_videoStreamIndex >= 0) {
+        m_formatContext->streams[m_videoStreamIndex]->discard = trickRate != 0 ? AVDISCARD_NONKEY : AVDISCARD_DEFAULT;
+    }
+    m_trickLastMs = -1;
+
+    // 跳转失败时从当前位置继续读取，仍然发布序号，已入队的旧数据照常丢弃，播放不会卡住
+    m_seekTargetMs.store(positionMs, std::memory_order_release);
+    m_trickRate.store(trickRate, std::memory_order_release);
+    m_serial.store(serial, std::memory_order_release);
+    // 唤醒等待数据包的解码线程，让它们立即看到新序号
+    m_videoPacketQueue.notifyAll();
+    m_audioPacketQueue.notifyAll();
+}
+
+bool Demuxer::seekTo(qint64 positionMs)
+{
+    if (!m_isOpened || !m_formatContext) {
+        qDebug() << "Cannot seek: demuxer not opened";
+        return false;
+    }
+
+    if (!seekToKeyframe(positionMs)) {
+        // 索引中没有记录：将毫秒转换为 AV_TIME_BASE 单位的时间戳，对所有流进行跳转
+        int64_t timestamp = av_rescale(positionMs, AV_TIME_BASE, 1000);
+        int ret = av_seek_frame(m_formatContext, -1, timestamp, AVSEEK_FLAG_BACKWARD);
+        if (ret < 0) {
+            qDebug() << "Failed to seek to position:" << positionMs << "ms";
+            return false;
+        }
+    }
+    m_readContinuous = false;
+
+    // 丢弃跳转前读到、尚未入队的数据包；已入队的由解码线程按序号丢弃
+    if (m_pendingPacket) {
+        av_packet_free(&m_pendingPacket);
+    }
+    m_isEof.store(false, std::memory_order_release);
+    return true;
+}
+
+bool Demuxer::seekToKeyframe(qint64 positionMs)
+{
+    AVStream *stream = getVideoStream();
+    KeyframeIndex::Entry entry;
+    if (!stream || !m_keyframeIndex.find(positionMs, entry)) {
+        return false;
+    }
+    // 扫描未完成或只由播放填充时，find() 找到的可能是已索引范围末尾、远在目标之前的关键帧，
+    // 跳过去会解码并丢弃大段数据；只有目标后面也有相邻的索引项时才说明目标在已覆盖的范围内
+    if (!m_keyframeIndex.isComplete()) {
+        KeyframeIndex::Entry next;
+        if (!m_keyframeIndex.findNext(positionMs, next) || next.ptsMs - entry.ptsMs > SEEK_INDEX_MAX_GAP_MS) {
+            return false;
+        }
+    }
+
+    // 时间戳不连续的容器按时间跳转需要反复二分读取，且结果不可靠，改为直接跳到关键帧的字节偏移
+    const AVInputFormat *format = m_formatContext->iformat;
+    bool byteSeek = entry.pos >= 0 && (format->flags & AVFMT_TS_DISCONT)
+                    && !(format->flags & AVFMT_NO_BYTE_SEEK);
+    if (byteSeek && av_seek_frame(m_formatContext, -1, entry.pos, AVSEEK_FLAG_BYTE) >= 0) {
+        return true;
+    }
+
+    // 索引中的毫秒向下取整，换算回流时间基时向上取整，保证不会越过该关键帧
+    int64_t keyframeTs = av_rescale_q_rnd(entry.ptsMs, AVRational{1, 1000}, stream->time_base, AV_ROUND_UP);
+    int ret = avformat_seek_file(m_formatContext, m_videoStreamIndex, INT64_MIN, keyframeTs, keyframeTs, 0);
+    return ret >= 0;
+}
+
+void Demuxer::indexKeyframe(const AVPacket *packet)
+{
+    if (packet->stream_index != m_videoStreamIndex || !(packet->flags & AV_PKT_FLAG_KEY)
+        || m_keyframeIndex.isComplete()) {
+        return;
+    }
+    int64_t ts = packet->pts != AV_NOPTS_VALUE ? packet->pts : packet->dts;
+    if (ts == AV_NOPTS_VALUE) {
+        return;
+    }
+    AVRational timeBase = m_formatContext->streams[m_videoStreamIndex]->time_base;
+    m_keyframeIndex.add(av_rescale_q_rnd(ts, timeBase, AVRational{1, 1000}, AV_ROUND_DOWN), packet->pos);
+}
+
+bool Demuxer::readPacket()
+{
+    AVPacket *packet = av_packet_alloc();
+    if (!packet) {
+        qDebug() << "Failed to allocate packet";
+        msleep(1);
+        return false;
+    }
+    int ret = av_read_frame(m_formatContext, packet);
+    if (ret < 0) {
+        av_packet_free(&packet);
+        if (ret == AVERROR_EOF || avio_feof(m_formatContext->pb)) {
+            m_isEof.store(true, std::memory_order_release);
+            if (m_readContinuous && !m_keyframeIndex.isComplete()) {
+                // 从头连续读到末尾，索引已覆盖整个文件，不必再等后台扫描
+                m_keyframeIndex.setComplete(true);
+                m_keyframeIndex.save(m_filePath);
+            }
+            // 唤醒等待数据包的解码线程，让它们看到文件结束
+            m_videoPacketQueue.notifyAll();
+            m_audioPacketQueue.notifyAll();
+            return false;
+        }
+        // 非 EOF 错误（如网络抖动），稍后重试
+        msleep(1);
+        return false;
+    }
+    indexKeyframe(packet);
+    m_pendingPacket = packet;
+    return true;
+}
+
+bool Demuxer::readTrickKeyframe()
+{
+    int trickRate = m_trickRate.load(std::memory_order_relaxed);
+    if (m_trickLastMs < 0) {
+        // 跳转后的第一帧：已经位于目标之前最近的关键帧
+        return readKeyframePacket(INT64_MIN);
+    }
+
+    // 按倍率跳过中间的关键帧，每秒最多解码 TRICK_PLAY_MAX_FPS 个关键帧
+    qint64 stepMs = qMax<qint64>(1, static_cast<qint64>(qAbs(trickRate)) * 1000 / TRICK_PLAY_MAX_FPS);
+    if (trickRate > 0) {
+        qint64 minMs = m_trickLastMs + stepMs;
+        KeyframeIndex::Entry entry;
+        // 索引尚未覆盖时跳到 minMs 之前的关键帧，再顺序读到 minMs 之后的第一个关键帧
+        seekTo(m_keyframeIndex.findNext(minMs, entry) ? entry.ptsMs : minMs);
+        return readKeyframePacket(minMs);
+    }
+
+    qint64 lastMs = m_trickLastMs;
+    qint64 targetMs = lastMs - stepMs;
+    for (int i = 0; i < TRICK_PLAY_MAX_BACKOFF; ++i) {
+        seekTo(qMax<qint64>(0, targetMs));
+        if (!readKeyframePacket(INT64_MIN)) {
+            return false;
+        }
+        if (m_trickLastMs < lastMs) {
+            return true;
+        }
+        // 没有索引时跳转可能落回上一个关键帧，继续向前退
+        av_packet_free(&m_pendingPacket);
+        m_trickLastMs = lastMs;
+        if (targetMs <= 0) {
+            break;
+        }
+        targetMs -= stepMs;
+    }
+    // 已退到文件开头，等待新的跳转请求
+    m_isEof.store(true, std::memory_order_release);
+    m_videoPacketQueue.notifyAll();
+    return false;
+}
+
+bool Demuxer::readKeyframePacket(qint64 minMs)
+{
+    AVPacket *packet = av_packet_alloc();
+    if (!packet) {
+        qDebug() << "Failed to allocate packet";
+        return false;
+    }
+    AVRational timeBase = m_formatContext->streams[m_videoStreamIndex]->time_base;
+    while (!hasPendingSeek() && !m_playerState->quitRequested()) {
+        int ret = av_read_frame(m_formatContext, packet);
+        if (ret < 0) {
+            if (ret == AVERROR_EOF || avio_feof(m_formatContext->pb)) {
+                m_isEof.store(true, std::memory_order_release);
+                m_videoPacketQueue.notifyAll();
+            }
+            break;
+        }
+        indexKeyframe(packet);
+        if (packet->stream_index == m_videoStreamIndex && (packet->flags & AV_PKT_FLAG_KEY)) {
+            int64_t ts = packet->pts != AV_NOPTS_VALUE ? packet->pts : packet->dts;
+            qint64 ptsMs = ts != AV_NOPTS_VALUE
+                    ? av_rescale_q_rnd(ts, timeBase, AVRational{1, 1000}, AV_ROUND_DOWN) : -1;
+            if (ptsMs >= 0 && ptsMs >= minMs) {
+                m_trickLastMs = ptsMs;
+                m_pendingPacket = packet;
+                return true;
+            }
+        }
+        av_packet_unref(packet);
+    }
+    av_packet_free(&packet);
+    return false;
+}
+
+void Demuxer::run()
+{
+    qDebug() << "Demuxer run";
+    while (m_isOpened && !m_playerState->quitRequested()) {
+        if (hasPendingSeek()) {
+            applyPendingSeek();
+            continue;
+        }
+
+        if (!m_playerState->isActive()) {
+            // 暂停或播放结束：挂起到状态变化，不退出线程
+            m_playerState->waitActive(WaitEvent::toTimeoutUs(DEMUXER_WAIT_TIMEOUT_MS));
+            continue;
+        }
+
+        if (m_isEof.load(std::memory_order_acquire)) {
+            // 文件已读完，挂起等待跳转请求，跳回去后继续读取
+            uint32_t token = m_wakeEvent.prepareWait();
+            if (hasPendingSeek() || m_playerState->quitRequested()) {
+                m_wakeEvent.cancelWait();
+                continue;
+            }
+            m_wakeEvent.wait(token, WaitEvent::toTimeoutUs(DEMUXER_WAIT_TIMEOUT_MS));
+            continue;
+        }
+
+        if (!m_pendingPacket) {
+            bool trickPlay = m_trickRate.load(std::memory_order_relaxed) != 0;
+            if (trickPlay && !m_videoPacketQueue.empty()) {
+                // 快进/快退时只预读一个关键帧，解码器取走之后再读下一个，倍率改变时丢弃的数据最少
+                m_videoPacketQueue.waitForPop(DEMUXER_WAIT_TIMEOUT_MS);
+                continue;
+            }
+            if (!(trickPlay ? readTrickKeyframe() : readPacket())) {
+                continue;
+            }
+        }
+
+        // 按流分发，同一份数据只读取一次
+        PacketQueue *queue = nullptr;
+        if (m_pendingPacket->stream_index == m_videoStreamIndex) {
+            queue = &m_videoPacketQueue;
+        } else if (m_pendingPacket->stream_index == m_audioStreamIndex) {
+            queue = &m_audioPacketQueue;
+        }
+
+        if (!queue) {
+            av_packet_free(&m_pendingPacket);
+            continue;
+        }
+
+        if (!queue->push(m_pendingPacket, m_serial.load(std::memory_order_relaxed))) {
+            // 队列已满，保留该包，挂起到解码线程取走数据包为止
+            queue->waitForPop(DEMUXER_WAIT_TIMEOUT_MS);
+            continue;
+        }
+        m_pendingPacket = nullptr;
+    }
+    qDebug() << "Demuxer run end";
+}
+
+void Demuxer::cleanup()
+{
+    // 扫描线程写入索引，先停止再清空
+    m_keyframeScanner->stopScan();
+    m_keyframeIndex.clear();
+    m_filePath.clear();
+
+    if (m_pendingPacket) {
+        av_packet_free(&m_pendingPacket);
+    }
+
+    m_videoPacketQueue.clear();
+    m_audioPacketQueue.clear();
+
+    if (m_formatContext) {
+        avformat_close_input(&m_formatContext);
+    }
+
+    m_videoStreamIndex = -1;
+    m_audioStreamIndex = -1;
+    m_isEof.store(false, std::memory_order_release);
+}
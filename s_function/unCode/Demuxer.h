@@ -0,0 +1,149 @@
+#ifndef DEMUXER_H
+#define DEMUXER_H
+
+#include <QObject>
+#include <QThread>
+#include <atomic>
+#include "PacketQueue.h"
+#include "../models/WaitEvent.h"
+#include "../models/PlayerState.h"
+#include "KeyframeIndex.h"
+#include "KeyframeScanner.h"
+
+#define DEMUXER_WAIT_TIMEOUT_MS 100 // 队列满时单次等待的最长时间
+#define TRICK_PLAY_MAX_FPS 8 // 快进/快退时每秒最多读取、解码的关键帧数，保证 CPU 占用不超过正常播放
+#define TRICK_PLAY_MAX_BACKOFF 8 // 快退时没有索引、跳转落在上一个关键帧之后时最多继续向前退的次数
+#define SEEK_INDEX_MAX_GAP_MS 10000 // 索引不完整时，目标两侧的关键帧相隔超过该时长视为索引空洞，不使用索引
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include <libavutil/avutil.h>
+}
+
+/**
+ * @brief 解复用线程
+ *
+ * 每个播放器只打开一次文件，只运行一个 av_read_frame 循环，
+ * 读取到的数据包按流分发到视频包队列和音频包队列，
+ * VideoCode 和 AudioCode 分别从对应队列中取包解码。
+ *
+ * 跳转是投递给解复用线程的命令：requestSeek() 只记录目标时间并递增播放器状态中的跳转序号，
+ * 真正的 av_seek 在解复用线程上执行，FFmpeg 状态只由工作线程访问。
+ * 连续的请求只保留最后一个，执行完成后发布新的序号，之后入队的数据包都带有该序号；
+ * 解码线程看到序号变化后自行冲刷解码器，渲染线程丢弃旧序号的帧。
+ *
+ * 快进/快退（trick play）同样随跳转请求切换：倍率非0时不再顺序读取，
+ * 而是按关键帧索引逐个跳到下一个（快退时为上一个）关键帧，只送出该关键帧的数据包，
+ * 音频流整个丢弃；相邻两个送出的关键帧至少间隔 倍率/TRICK_PLAY_MAX_FPS 秒的媒体时间。
+ */
+class Demuxer : public QThread
+{
+    Q_OBJECT
+
+public:
+    explicit Demuxer(QObject *parent = nullptr);
+    ~Demuxer();
+
+    bool openFile(const QString &filePath);
+    void closeFile();
+
+    // 设置共享的播放器状态（不持有），start() 之前调用
+    void setPlayerState(PlayerState *playerState) { m_playerState = playerState; }
+    // 唤醒挂起在包队列上或在文件末尾等待的解复用线程，让它重新检查状态
+    void wakeUp();
+
+    /**
+     * @brief 请求跳转（任意线程调用，不阻塞），播放器状态随之进入 Seeking
+     * @param positionMs 目标时间（毫秒），解码器随后丢弃目标时间之前的帧
+     * @param trickRate 跳转后的快进/快退倍率，正数快进、负数快退，0 表示正常播放
+     * @return 本次请求的序号，渲染线程据此判断数据是否属于最新的请求；未打开文件时返回 -1
+     */
+    int requestSeek(qint64 positionMs, int trickRate = 0);
+    // 最新一次跳转请求的序号，新请求会取代尚未执行的旧请求
+    int getRequestedSerial() const { return m_playerState->seekSerial(); }
+    // 已执行的跳转序号，之后入队的数据包都带有该序号
+    int getSerial() const { return m_serial.load(std::memory_order_acquire); }
+    // 已执行的跳转的目标时间（毫秒），打开文件后尚未跳转时为 -1；先读取序号再读取目标
+    qint64 getSeekTarget() const { return m_seekTargetMs.load(std::memory_order_acquire); }
+    // 已执行的跳转的快进/快退倍率，0 表示正常播放；先读取序号再读取倍率
+    int getTrickRate() const { return m_trickRate.load(std::memory_order_acquire); }
+
+    // 容器没有完整索引时是否后台逐包扫描关键帧（默认关闭，扫描会把文件再读一遍），openFile() 之前调用
+    void setKeyframeScanEnabled(bool enabled) { m_keyframeScanEnabled = enabled; }
+    const KeyframeIndex &getKeyframeIndex() const { return m_keyframeIndex; }
+
+    int getDuration() const;  // 返回总时长（秒）
+    bool isOpened() const { return m_isOpened; }
+    // 是否已读到文件末尾
+    bool isEof() const { return m_isEof.load(std::memory_order_acquire); }
+
+    AVFormatContext *getFormatContext() const { return m_formatContext; }
+    int getVideoStreamIndex() const { return m_videoStreamIndex; }
+    int getAudioStreamIndex() const { return m_audioStreamIndex; }
+    AVStream *getVideoStream() const;
+    AVStream *getAudioStream() const;
+
+    PacketQueue &getVideoPacketQueue() { return m_videoPacketQueue; }
+    PacketQueue &getAudioPacketQueue() { return m_audioPacketQueue; }
+
+private:
+    void run() override;
+    void cleanup();
+    // 记录读到的视频关键帧数据包
+    void indexKeyframe(const AVPacket *packet);
+    // 顺序读取下一个数据包到 m_pendingPacket，读到文件末尾或出错时返回 false
+    bool readPacket();
+    // 快进/快退：跳到下一个要显示的关键帧并把它的数据包读到 m_pendingPacket
+    bool readTrickKeyframe();
+    // 从当前位置读取第一个时间不早于 minMs 的视频关键帧数据包，有新的跳转请求时放弃
+    bool readKeyframePacket(qint64 minMs);
+    /**
+     * @brief 跳转到指定时间之前最近的关键帧（仅由解复用线程调用）
+     *
+     * 关键帧索引中有记录时直接跳到该关键帧：不连续时间戳的容器（如 TS）按字节偏移跳转，
+     * 其他容器按该关键帧的时间戳跳转；没有记录时回退到按时间跳转。
+     */
+    bool seekTo(qint64 positionMs);
+    // 按关键帧索引跳转，索引中没有记录或跳转失败时返回 false
+    bool seekToKeyframe(qint64 positionMs);
+    // 执行最新的跳转请求并发布其序号
+    void applyPendingSeek();
+    bool hasPendingSeek() const { return getRequestedSerial() != getSerial(); }
+
+    AVFormatContext *m_formatContext;
+    int m_videoStreamIndex;
+    int m_audioStreamIndex;
+
+    // 因队列已满暂未送出的数据包
+    AVPacket *m_pendingPacket;
+    bool m_isOpened;
+    std::atomic<bool> m_isEof;
+
+    // 播放器状态（不持有），暂停时挂起，要求退出时结束 run()
+    PlayerState *m_playerState;
+    // 文件末尾等待跳转请求时使用，请求跳转和停止时唤醒
+    WaitEvent m_wakeEvent;
+
+    // 跳转命令：请求方写入目标并递增播放器状态中的跳转序号，解复用线程执行后发布序号和目标
+    std::atomic<qint64> m_requestedMs;
+    std::atomic<int> m_serial;
+    std::atomic<qint64> m_seekTargetMs;
+    std::atomic<int> m_requestedTrickRate;
+    std::atomic<int> m_trickRate;
+    // 快进/快退时最近送出的关键帧时间（毫秒），跳转后为 -1，只由解复用线程访问
+    qint64 m_trickLastMs;
+
+    PacketQueue m_videoPacketQueue;
+    PacketQueue m_audioPacketQueue;
+
+    // 关键帧索引，播放时和后台扫描同时补充
+    QString m_filePath;
+    KeyframeIndex m_keyframeIndex;
+    KeyframeScanner *m_keyframeScanner;
+    bool m_keyframeScanEnabled;
+    // 自打开以来是否从头连续读取（未跳转），连续读到文件末尾时索引即完整
+    bool m_readContinuous;
+};
+
+#endif // DEMUXER_H
@@ -0,0 +1,118 @@
+#include "FramePool.h"
+#include <QDebug>
+
+extern "C" {
+#include <libavutil/mem.h>
+}
+
+static int bytesPerPixel(QImage::Format format)
+{
+    switch (format) {
+    case QImage::Format_RGB888:
+        return 3;
+    case QImage::Format_RGB32:
+    case QImage::Format_ARGB32:
+    case QImage::Format_ARGB32_Premultiplied:
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+std::shared_ptr<FramePool> FramePool::create(int maxFreeBuffers)
+{
+    return std::shared_ptr<FramePool>(new FramePool(maxFreeBuffers));
+}
+
+FramePool::FramePool(int maxFreeBuffers)
+    : m_maxFreeBuffers(maxFreeBuffers)
+    , m_hitCount(0)
+    , m_missCount(0)
+{
+    m_freeBuffers.reserve(maxFreeBuffers);
+}
+
+FramePool::~FramePool()
+{
+    clear();
+}
+
+QImage FramePool::acquire(int width, int height, QImage::Format format)
+{
+    int pixelSize = bytesPerPixel(format);
+    if (width <= 0 || height <= 0 || pixelSize <= 0) {
+        return QImage();
+    }
+
+    // 每行按 64 字节对齐，便于 sws_scale 的 SIMD 写入
+    qint64 bytesPerLine = (static_cast<qint64>(width) * pixelSize + 63) & ~static_cast<qint64>(63);
+    qint64 size = bytesPerLine * height;
+
+    Buffer *buffer = nullptr;
+    {
+        QMutexLocker locker(&m_mutex);
+        for (size_t i = 0; i < m_freeBuffers.size(); ++i) {
+            if (m_freeBuffers[i]->size >= size) {
+                buffer = m_freeBuffers[i];
+                m_freeBuffers[i] = m_freeBuffers.back();
+                m_freeBuffers.pop_back();
+                break;
+            }
+        }
+    }
+
+    if (buffer) {
+        m_hitCount.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        m_missCount.fetch_add(1, std::memory_order_relaxed);
+        buffer = new Buffer;
+        buffer->data = static_cast<uchar *>(av_malloc(size));
+        buffer->size = size;
+        if (!buffer->data) {
+            qDebug() << "Failed to allocate frame buffer, size:" << size;
+            delete buffer;
+            return QImage();
+        }
+    }
+
+    buffer->owner = shared_from_this();
+    return QImage(buffer->data, width, height, bytesPerLine, format, &FramePool::releaseBuffer, buffer);
+}
+
+void FramePool::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    for (Buffer *buffer : m_freeBuffers) {
+        freeBuffer(buffer);
+    }
+    m_freeBuffers.clear();
+}
+
+void FramePool::releaseBuffer(void *info)
+{
+    Buffer *buffer = static_cast<Buffer *>(info);
+    // 先取走池的引用，归还完成后池才可能被析构
+    std::shared_ptr<FramePool> owner = std::move(buffer->owner);
+    if (owner) {
+        owner->recycle(buffer);
+    } else {
+        freeBuffer(buffer);
+    }
+}
+
+void FramePool::recycle(Buffer *buffer)
+{
+    QMutexLocker locker(&m_mutex);
+    if (static_cast<int>(m_freeBuffers.size()) < m_maxFreeBuffers) {
+        m_freeBuffers.push_back(buffer);
+        return;
+    }
+    locker.unlock();
+    freeBuffer(buffer);
+}
+
+void FramePool::freeBuffer(Buffer *buffer)
+{
+    av_free(buffer->data);
+    delete buffer;
+}
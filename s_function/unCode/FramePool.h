@@ -0,0 +1,69 @@
+#ifndef FRAMEPOOL_H
+#define FRAMEPOOL_H
+
+#include <QImage>
+#include <QMutex>
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#define FRAME_POOL_MAX_FREE_BUFFERS 8
+
+/**
+ * @brief 视频帧缓冲池
+ *
+ * 解码线程从池中取出 QImage，sws_scale 直接写入其像素内存；
+ * QImage 的最后一个引用释放时（通常在显示之后），缓冲区自动归还到池中。
+ * 稳定播放时每帧不再申请/释放整帧大小的内存，也不再做额外的整帧拷贝。
+ *
+ * 注意事项：
+ * - 必须通过 create() 创建，池以 shared_ptr 管理，借出的缓冲区持有池的引用，
+ *   保证池先于图像销毁时也能安全归还
+ * - 借出的 QImage 只能以只读方式共享，对其调用非 const 接口会触发深拷贝
+ */
+class FramePool : public std::enable_shared_from_this<FramePool>
+{
+public:
+    static std::shared_ptr<FramePool> create(int maxFreeBuffers = FRAME_POOL_MAX_FREE_BUFFERS);
+    ~FramePool();
+
+    /**
+     * @brief 取出一块图像缓冲（线程安全）
+     * @return 像素内存来自池的 QImage，失败返回空 QImage
+     * @note 每行字节数按 64 字节对齐，写入时应使用 bytesPerLine()
+     */
+    QImage acquire(int width, int height, QImage::Format format);
+
+    /**
+     * @brief 释放池中所有空闲缓冲区，已借出的缓冲区归还后按正常流程处理
+     */
+    void clear();
+
+    // 命中：复用了空闲缓冲区；未命中：新申请了缓冲区
+    quint64 hitCount() const { return m_hitCount.load(std::memory_order_relaxed); }
+    quint64 missCount() const { return m_missCount.load(std::memory_order_relaxed); }
+
+private:
+    explicit FramePool(int maxFreeBuffers);
+
+    struct Buffer
+    {
+        uchar *data;
+        qint64 size;
+        // 借出期间持有池的引用，归还时释放
+        std::shared_ptr<FramePool> owner;
+    };
+
+    static void releaseBuffer(void *info);
+    void recycle(Buffer *buffer);
+    static void freeBuffer(Buffer *buffer);
+
+    QMutex m_mutex;
+    std::vector<Buffer *> m_freeBuffers;
+    int m_maxFreeBuffers;
+
+    std::atomic<quint64> m_hitCount;
+    std::atomic<quint64> m_missCount;
+};
+
+#endif // FRAMEPOOL_H
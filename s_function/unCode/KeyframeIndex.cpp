@@ -0,0 +1,163 @@
+#include "KeyframeIndex.h"
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <algorithm>
+
+KeyframeIndex::KeyframeIndex()
+    : m_complete(false)
+{
+
+}
+
+void KeyframeIndex::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    m_entries.clear();
+    m_complete.store(false, std::memory_order_release);
+}
+
+void KeyframeIndex::add(qint64 ptsMs, qint64 pos)
+{
+    QMutexLocker locker(&m_mutex);
+    // 播放和扫描基本按时间顺序添加，绝大多数情况直接追加到末尾
+    if (m_entries.empty() || m_entries.back().ptsMs < ptsMs) {
+        m_entries.push_back(Entry{ptsMs, pos});
+        return;
+    }
+    auto it = std::lower_bound(m_entries.begin(), m_entries.end(), ptsMs,
+                               [](const Entry &entry, qint64 value) { return entry.ptsMs < value; });
+    if (it != m_entries.end() && it->ptsMs == ptsMs) {
+        if (it->pos < 0) {
+            it->pos = pos;
+        }
+        return;
+    }
+    m_entries.insert(it, Entry{ptsMs, pos});
+}
+
+bool KeyframeIndex::find(qint64 targetMs, Entry &entry) const
+{
+    QMutexLocker locker(&m_mutex);
+    auto it = std::upper_bound(m_entries.begin(), m_entries.end(), targetMs,
+                               [](qint64 value, const Entry &e) { return value < e.ptsMs; });
+    if (it == m_entries.begin()) {
+        return false;
+    }
+    entry = *(it - 1);
+    return true;
+}
+
+bool KeyframeIndex::findNext(qint64 targetMs, Entry &entry) const
+{
+    QMutexLocker locker(&m_mutex);
+    auto it = std::lower_bound(m_entries.begin(), m_entries.end(), targetMs,
+                               [](const Entry &e, qint64 value) { return e.ptsMs < value; });
+    if (it == m_entries.end()) {
+        return false;
+    }
+    entry = *it;
+    return true;
+}
+
+int KeyframeIndex::size() const
+{
+    QMutexLocker locker(&m_mutex);
+    return static_cast<int>(m_entries.size());
+}
+
+QString KeyframeIndex::cacheFilePath(const QString &mediaPath)
+{
+    QFileInfo info(mediaPath);
+    if (!info.isFile()) {
+        return QString();
+    }
+    // 文件被替换或修改后键值随之变化，旧缓存不会被误用
+    QByteArray key = info.absoluteFilePath().toUtf8();
+    key += '|' + QByteArray::number(info.size());
+    key += '|' + QByteArray::number(info.lastModified().toMSecsSinceEpoch());
+    QString name = QString::fromLatin1(QCryptographicHash::hash(key, QCryptographicHash::Md5).toHex());
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation)
+            + "/keyframes/" + name + ".idx";
+}
+
+bool KeyframeIndex::load(const QString &mediaPath)
+{
+    QString path = cacheFilePath(mediaPath);
+    if (path.isEmpty()) {
+        return false;
+    }
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    quint32 magic = 0;
+    quint32 version = 0;
+    quint32 count = 0;
+    stream >> magic >> version >> count;
+    if (magic != KEYFRAME_INDEX_MAGIC || version != KEYFRAME_INDEX_VERSION) {
+        qDebug() << "Ignore keyframe index cache with unknown format:" << path;
+        return false;
+    }
+
+    // 条目数来自文件内容，先按文件大小校验，损坏的缓存不能触发超大的预分配
+    const qint64 headerSize = 3 * sizeof(quint32);
+    const qint64 entrySize = 2 * sizeof(qint64);
+    if (count > (file.size() - headerSize) / entrySize) {
+        qDebug() << "Keyframe index cache is truncated:" << path;
+        return false;
+    }
+
+    std::vector<Entry> entries;
+    entries.reserve(count);
+    for (quint32 i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        Entry entry;
+        stream >> entry.ptsMs >> entry.pos;
+        entries.push_back(entry);
+    }
+    if (stream.status() != QDataStream::Ok) {
+        qDebug() << "Keyframe index cache is truncated:" << path;
+        return false;
+    }
+
+    QMutexLocker locker(&m_mutex);
+    m_entries.swap(entries);
+    m_complete.store(true, std::memory_order_release);
+    return true;
+}
+
+bool KeyframeIndex::save(const QString &mediaPath) const
+{
+    if (!isComplete()) {
+        return false;
+    }
+    QString path = cacheFilePath(mediaPath);
+    if (path.isEmpty() || !QDir().mkpath(QFileInfo(path).absolutePath())) {
+        return false;
+    }
+
+    // 先写临时文件再替换，写到一半退出不会留下损坏的缓存
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "Failed to write keyframe index cache:" << path;
+        return false;
+    }
+    QDataStream stream(&file);
+    {
+        QMutexLocker locker(&m_mutex);
+        stream << quint32(KEYFRAME_INDEX_MAGIC) << quint32(KEYFRAME_INDEX_VERSION)
+               << quint32(m_entries.size());
+        for (const Entry &entry : m_entries) {
+            stream << entry.ptsMs << entry.pos;
+        }
+    }
+    return file.commit();
+}
@@ -0,0 +1,85 @@
+#ifndef KEYFRAMEINDEX_H
+#define KEYFRAMEINDEX_H
+
+#include <QString>
+#include <QMutex>
+#include <atomic>
+#include <vector>
+
+#define KEYFRAME_INDEX_MAGIC 0x4B464958 // 缓存文件标识 "KFIX"
+#define KEYFRAME_INDEX_VERSION 1 // 缓存文件格式版本，格式变化时递增，旧缓存自动失效
+
+/**
+ * @brief 单个媒体文件的视频关键帧索引（时间 → 字节偏移）
+ *
+ * 索引有三个来源：
+ * - Demuxer 播放时读到的关键帧数据包
+ * - 打开文件时从主上下文读取的容器自带索引，没有完整索引时由 KeyframeScanner 后台逐包扫描（可选）
+ * - 上一次完整扫描后保存的缓存文件
+ * 跳转时由 find() 找到目标时间之前最近的关键帧，直接跳到该关键帧，
+ * 再由解码器丢弃目标时间之前的帧。
+ *
+ * 注意事项：
+ * - 时间戳是视频流 PTS 换算的毫秒数，与 VideoData::timestamp 同一时间轴
+ * - 所有方法线程安全，播放线程和扫描线程可以同时添加
+ * - 只保存完整的索引，不完整的索引在下次打开时重新扫描
+ */
+class KeyframeIndex
+{
+public:
+    struct Entry {
+        qint64 ptsMs;   // 关键帧时间戳（毫秒，向下取整）
+        qint64 pos;     // 关键帧数据包在文件中的字节偏移，未知为 -1
+    };
+
+    KeyframeIndex();
+
+    KeyframeIndex(const KeyframeIndex &) = delete;
+    KeyframeIndex &operator=(const KeyframeIndex &) = delete;
+
+    void clear();
+
+    /**
+     * @brief 添加一个关键帧，时间戳已存在时只补全未知的字节偏移
+     */
+    void add(qint64 ptsMs, qint64 pos);
+
+    /**
+     * @brief 查找目标时间之前（含）最近的关键帧
+     * @return false 索引中没有目标时间之前的关键帧
+     */
+    bool find(qint64 targetMs, Entry &entry) const;
+    /**
+     * @brief 查找目标时间之后（含）最近的关键帧，用于快进时选取下一个关键帧
+     * @return false 索引中没有目标时间之后的关键帧
+     */
+    bool findNext(qint64 targetMs, Entry &entry) const;
+
+    int size() const;
+
+    // 是否已覆盖整个文件（扫描完成或从头连续播放到文件末尾）
+    bool isComplete() const { return m_complete.load(std::memory_order_acquire); }
+    void setComplete(bool complete) { m_complete.store(complete, std::memory_order_release); }
+
+    /**
+     * @brief 读取媒体文件对应的索引缓存，文件大小或修改时间变化后缓存失效
+     * @return false 没有可用的缓存
+     */
+    bool load(const QString &mediaPath);
+
+    /**
+     * @brief 保存完整的索引到缓存目录，不完整时不保存
+     */
+    bool save(const QString &mediaPath) const;
+
+private:
+    // 缓存文件路径：缓存目录/keyframes/md5(路径+大小+修改时间).idx，非本地文件返回空
+    static QString cacheFilePath(const QString &mediaPath);
+
+    mutable QMutex m_mutex;
+    // 按时间戳升序排列
+    std::vector<Entry> m_entries;
+    std::atomic<bool> m_complete;
+};
+
+#endif // KEYFRAMEINDEX_H
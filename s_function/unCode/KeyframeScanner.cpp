@@ -0,0 +1,157 @@
+#include "KeyframeScanner.h"
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QStorageInfo>
+
+#define KEYFRAME_SCAN_MAX_GOP_MS 10000 // 容器索引最后一个关键帧距文件末尾不超过该时长时视为完整
+
+KeyframeScanner::KeyframeScanner(QObject *parent)
+    : QThread(parent)
+    , m_index(nullptr)
+    , m_stopRequested(false)
+{
+
+}
+
+KeyframeScanner::~KeyframeScanner()
+{
+    stopScan();
+}
+
+void KeyframeScanner::startScan(const QString &filePath, KeyframeIndex *index)
+{
+    stopScan();
+    m_filePath = filePath;
+    m_index = index;
+    m_stopRequested.store(false);
+    // 扫描只为以后的跳转服务，不能与播放争抢 CPU 和 IO
+    start(QThread::LowestPriority);
+}
+
+void KeyframeScanner::stopScan()
+{
+    m_stopRequested.store(true);
+    if (isRunning()) {
+        wait();
+    }
+}
+
+int KeyframeScanner::interruptCallback(void *opaque)
+{
+    KeyframeScanner *scanner = static_cast<KeyframeScanner*>(opaque);
+    return scanner->m_stopRequested.load() ? 1 : 0;
+}
+
+void KeyframeScanner::run()
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    AVFormatContext *formatContext = avformat_alloc_context();
+    if (!formatContext) {
+        return;
+    }
+    formatContext->interrupt_callback.callback = &KeyframeScanner::interruptCallback;
+    formatContext->interrupt_callback.opaque = this;
+
+    // 打开失败时 avformat_open_input 会释放 formatContext
+    if (avformat_open_input(&formatContext, m_filePath.toUtf8().constData(), nullptr, nullptr) < 0) {
+        qDebug() << "Keyframe scan failed to open:" << m_filePath;
+        return;
+    }
+    if (avformat_find_stream_info(formatContext, nullptr) < 0) {
+        avformat_close_input(&formatContext);
+        return;
+    }
+    int streamIndex = av_find_best_stream(formatContext, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
+    if (streamIndex < 0) {
+        avformat_close_input(&formatContext);
+        return;
+    }
+
+    bool complete = readPackets(formatContext, streamIndex);
+    avformat_close_input(&formatContext);
+
+    if (complete) {
+        m_index->setComplete(true);
+        m_index->save(m_filePath);
+        qDebug() << "Keyframe scan finished:" << m_index->size() << "keyframes in" << timer.elapsed() << "ms";
+    }
+}
+
+bool KeyframeScanner::readContainerIndex(AVFormatContext *formatContext, int streamIndex, KeyframeIndex *index)
+{
+    AVStream *stream = formatContext->streams[streamIndex];
+    int count = avformat_index_get_entries_count(stream);
+    qint64 lastMs = -1;
+    for (int i = 0; i < count; ++i) {
+        const AVIndexEntry *entry = avformat_index_get_entry(stream, i);
+        if (!entry || !(entry->flags & AVINDEX_KEYFRAME) || entry->timestamp == AV_NOPTS_VALUE) {
+            continue;
+        }
+        lastMs = av_rescale_q_rnd(entry->timestamp, stream->time_base, AVRational{1, 1000}, AV_ROUND_DOWN);
+        index->add(lastMs, entry->pos);
+    }
+    if (lastMs < 0 || formatContext->duration == AV_NOPTS_VALUE) {
+        return false;
+    }
+
+    // 部分解复用器只在读取过程中逐步建立索引，此时索引只覆盖文件开头，仍需逐包扫描
+    qint64 startMs = 0;
+    if (stream->start_time != AV_NOPTS_VALUE) {
+        startMs = av_rescale_q(stream->start_time, stream->time_base, AVRational{1, 1000});
+    }
+    qint64 durationMs = formatContext->duration / 1000;
+    return lastMs - startMs + KEYFRAME_SCAN_MAX_GOP_MS >= durationMs;
+}
+
+bool KeyframeScanner::isLocalFile(const QString &filePath)
+{
+    QFileInfo info(filePath);
+    if (!info.isFile()) {
+        return false;
+    }
+    QByteArray type = QStorageInfo(info.absolutePath()).fileSystemType();
+    // fuseblk 是本地块设备上的 FUSE 文件系统（如 ntfs-3g），fuse.* 多为远程挂载（vmhgfs-fuse、sshfs）
+    static const char *const networkTypes[] = {"nfs", "cifs", "smb", "9p", "vmhgfs", "fuse.", "afs", "ceph", "glusterfs"};
+    for (const char *networkType : networkTypes) {
+        if (type.startsWith(networkType)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool KeyframeScanner::readPackets(AVFormatContext *formatContext, int streamIndex)
+{
+    // 只解复用视频流，其他流的数据包直接丢弃
+    for (unsigned int i = 0; i < formatContext->nb_streams; ++i) {
+        if (static_cast<int>(i) != streamIndex) {
+            formatContext->streams[i]->discard = AVDISCARD_ALL;
+        }
+    }
+    AVRational timeBase = formatContext->streams[streamIndex]->time_base;
+
+    AVPacket *packet = av_packet_alloc();
+    if (!packet) {
+        return false;
+    }
+    bool reachedEof = false;
+    while (!m_stopRequested.load()) {
+        int ret = av_read_frame(formatContext, packet);
+        if (ret < 0) {
+            reachedEof = (ret == AVERROR_EOF);
+            break;
+        }
+        if (packet->stream_index == streamIndex && (packet->flags & AV_PKT_FLAG_KEY)) {
+            int64_t ts = packet->pts != AV_NOPTS_VALUE ? packet->pts : packet->dts;
+            if (ts != AV_NOPTS_VALUE) {
+                m_index->add(av_rescale_q_rnd(ts, timeBase, AVRational{1, 1000}, AV_ROUND_DOWN), packet->pos);
+            }
+        }
+        av_packet_unref(packet);
+    }
+    av_packet_free(&packet);
+    return reachedEof;
+}
@@ -0,0 +1,61 @@
+#ifndef KEYFRAMESCANNER_H
+#define KEYFRAMESCANNER_H
+
+#include <QObject>
+#include <QThread>
+#include <atomic>
+#include "KeyframeIndex.h"
+
+extern "C" {
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include <libavutil/avutil.h>
+}
+
+/**
+ * @brief 关键帧索引后台扫描线程
+ *
+ * 容器自带的索引（如 MP4 的 stss、MKV 的 cues）在探测时已经读入，由 Demuxer 打开文件时
+ * 通过 readContainerIndex() 直接从主上下文取得，不再打开文件。
+ * 只有容器没有完整索引（如 TS）时才需要本线程：另外打开一份文件，只读取视频流的数据包
+ * （不解码），记录关键帧的时间戳和字节偏移，这相当于把整个文件再读一遍，因此默认不启用。
+ * 扫描完成后把索引标记为完整并保存缓存，下次打开同一文件时直接使用。
+ *
+ * 注意事项：
+ * - 以最低优先级运行，只扫描本地磁盘上的文件（见 isLocalFile()）
+ * - stopScan() 会中断阻塞中的读取并等待线程结束
+ */
+class KeyframeScanner : public QThread
+{
+    Q_OBJECT
+
+public:
+    explicit KeyframeScanner(QObject *parent = nullptr);
+    ~KeyframeScanner();
+
+    // 开始扫描，结果写入 index（不持有，stopScan() 之前必须保持有效）
+    void startScan(const QString &filePath, KeyframeIndex *index);
+    void stopScan();
+
+    /**
+     * @brief 从已打开的上下文中读取容器自带的关键帧索引（调用时不能有其他线程在读取该上下文）
+     * @return true 索引覆盖整个文件
+     */
+    static bool readContainerIndex(AVFormatContext *formatContext, int streamIndex, KeyframeIndex *index);
+
+    // 文件是否位于本地磁盘；网络文件系统（NFS、SMB、hgfs 等 FUSE 挂载）上再读一遍文件的代价太高
+    static bool isLocalFile(const QString &filePath);
+
+private:
+    void run() override;
+    // 逐包读取视频流，读到文件末尾返回 true
+    bool readPackets(AVFormatContext *formatContext, int streamIndex);
+    // 读取阻塞时 FFmpeg 回调，返回非0中断读取
+    static int interruptCallback(void *opaque);
+
+    QString m_filePath;
+    KeyframeIndex *m_index;
+    std::atomic<bool> m_stopRequested;
+};
+
+#endif // KEYFRAMESCANNER_H
@@ -0,0 +1,71 @@
+#include "PacketQueue.h"
+
+PacketQueue::PacketQueue(qint64 maxBytes)
+    : m_bytes(0)
+    , m_maxBytes(maxBytes)
+{
+
+}
+
+PacketQueue::~PacketQueue()
+{
+    clear();
+}
+
+bool PacketQueue::isFull() const
+{
+    return m_bytes.load(std::memory_order_relaxed) >= m_maxBytes || m_queue.full();
+}
+
+bool PacketQueue::push(AVPacket *packet, int serial)
+{
+    if (!packet || isFull()) {
+        return false;
+    }
+
+    // 先计入字节数，再入队，避免消费者出队后出现负数
+    int size = packet->size;
+    m_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (!m_queue.push(Entry{packet, serial})) {
+        m_bytes.fetch_sub(size, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+void PacketQueue::take(const Entry &entry, AVPacket *&packet, int *serial)
+{
+    packet = entry.packet;
+    m_bytes.fetch_sub(packet->size, std::memory_order_relaxed);
+    if (serial) {
+        *serial = entry.serial;
+    }
+}
+
+bool PacketQueue::pop(AVPacket *&packet, int *serial)
+{
+    Entry entry;
+    if (!m_queue.pop(entry)) {
+        return false;
+    }
+    take(entry, packet, serial);
+    return true;
+}
+
+bool PacketQueue::waitPop(AVPacket *&packet, int timeoutMs, int *serial)
+{
+    Entry entry;
+    if (!m_queue.waitPop(entry, timeoutMs)) {
+        return false;
+    }
+    take(entry, packet, serial);
+    return true;
+}
+
+void PacketQueue::clear()
+{
+    AVPacket *packet = nullptr;
+    while (pop(packet)) {
+        av_packet_free(&packet);
+    }
+}
@@ -0,0 +1,97 @@
+#ifndef PACKETQUEUE_H
+#define PACKETQUEUE_H
+
+#include <QtGlobal>
+#include <atomic>
+#include "../models/SPSCLockFreeQueue.h"
+
+extern "C" {
+#include <libavcodec/avcodec.h>
+}
+
+#define MAX_PACKET_QUEUE_SIZE 1024
+#define MAX_VIDEO_PACKET_BYTES (16 * 1024 * 1024) // 视频包队列上限 16MB
+#define MAX_AUDIO_PACKET_BYTES (2 * 1024 * 1024)  // 音频包队列上限 2MB
+
+/**
+ * @brief 按字节数限流的压缩包队列
+ *
+ * 由解复用线程（生产者）写入，由解码线程（消费者）读取。
+ * 队列中保存的是 AVPacket 指针，入队成功后所有权转移给队列，
+ * 出队后由调用者负责 av_packet_free。
+ *
+ * 每个数据包附带解复用器的跳转序号，跳转后消费者按序号丢弃旧位置的数据包，
+ * 队列本身不需要由生产者清空。
+ */
+class PacketQueue
+{
+public:
+    explicit PacketQueue(qint64 maxBytes);
+    ~PacketQueue();
+
+    /**
+     * @brief 入队（仅由生产者线程调用）
+     * @param packet 要入队的数据包，成功时所有权转移给队列
+     * @param serial 数据包所属的跳转序号
+     * @return true 成功，false 队列已满（字节数或槽位）
+     * @note 只要当前字节数未超过上限就允许入队，保证单个超大包也能通过
+     */
+    bool push(AVPacket *packet, int serial = 0);
+
+    /**
+     * @brief 出队（仅由消费者线程调用）
+     * @param packet 出队的数据包，由调用者释放
+     * @param serial 输出数据包所属的跳转序号，可为空
+     * @return true 成功，false 队列为空
+     */
+    bool pop(AVPacket *&packet, int *serial = nullptr);
+
+    /**
+     * @brief 阻塞出队（仅由消费者线程调用）
+     * @param timeoutMs 超时时间（毫秒），< 0 表示一直等待
+     * @return true 成功，false 超时或被 notifyAll() 唤醒
+     */
+    bool waitPop(AVPacket *&packet, int timeoutMs, int *serial = nullptr);
+
+    /**
+     * @brief 等待队列非空，不取出数据（仅由消费者线程调用）
+     */
+    bool waitForData(int timeoutMs) { return m_queue.waitForData(timeoutMs); }
+
+    /**
+     * @brief 等待消费者取走数据包（仅由生产者线程在队列满时调用）
+     */
+    bool waitForPop(int timeoutMs) { return m_queue.waitForPop(timeoutMs); }
+
+    /**
+     * @brief 唤醒两端的等待者，用于停止、到达文件末尾等需要重新检查状态的场景
+     */
+    void notifyAll() { m_queue.notifyAll(); }
+
+    bool empty() const { return m_queue.empty(); }
+    bool isFull() const;
+
+    // 当前队列中压缩数据的字节数（近似值）
+    qint64 bytes() const { return m_bytes.load(std::memory_order_relaxed); }
+    qint64 maxBytes() const { return m_maxBytes; }
+
+    /**
+     * @brief 清空队列并释放所有数据包（仅由消费者线程调用，或两端都已停止时调用）
+     */
+    void clear();
+
+private:
+    struct Entry {
+        AVPacket *packet = nullptr;
+        int serial = 0;
+    };
+
+    // 出队后扣除字节数，输出数据包和序号
+    void take(const Entry &entry, AVPacket *&packet, int *serial);
+
+    SPSCLockFreeQueue<Entry, MAX_PACKET_QUEUE_SIZE, true> m_queue;
+    std::atomic<qint64> m_bytes;
+    qint64 m_maxBytes;
+};
+
+#endif // PACKETQUEUE_H
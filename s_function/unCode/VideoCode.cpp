@@ -1,18 +1,43 @@
 #include "VideoCode.h"
 #include <QDebug>
 #include <QDateTime>
+#include <chrono>
+
+static int64_t steadyNowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
 
 VideoCode::VideoCode(QObject *parent)
     : QThread(parent)
-    , m_formatContext(nullptr)
+    , m_demuxer(nullptr)
+    , m_packetQueue(nullptr)
     , m_videoCodecContext(nullptr)
-    , m_swsContext(nullptr)
-    , m_videoStreamIndex(-1)
-    , m_packet(nullptr)
     , m_videoFrame(nullptr)
+    , m_videoStream(nullptr)
+    , m_pendingPacket(nullptr)
+    , m_flushSent(false)
+    , m_trickPlay(false)
+    , m_trickDrain(false)
+    , m_frameSkipLevel(0)
+    , m_appliedSkipLevel(0)
+    , m_packetsInFlight(0)
+    , m_masterClockMs(-1)
+    , m_lastPushedMs(-1)
+    , m_droppedFrames(0)
     , m_isOpened(false)
+    , m_serial(0)
+    , m_seekTargetMs(-1)
     , m_videoFps(0.0)
-    , m_isPlaying(true)
+    , m_threadCount(0)
+    , m_threadType(DecodeThreadAuto)
+    , m_decodeBusyNs(0)
+    , m_decodedFrames(0)
+    , m_decodeFps(0.0)
+    , m_playerState(nullptr)
+    , m_drainedSerial(-1)
+    , m_decodeBudget(VIDEO_DECODE_AHEAD_BYTES, VIDEO_DECODE_AHEAD_MS)
 {
     
 }
@@ -21,93 +46,134 @@ VideoCode::~VideoCode()
 {
     // 先停止线程并等待结束，避免 "Destroyed while thread is still running" 错误
     if (isRunning()) {
-        setPlaying(false);
+        m_playerState->requestQuit();
+        wakeUp();
         wait();  // 等待线程结束
     }
     closeVideo();
 }
 
-void VideoCode::setPlaying(bool isPlaying)
+void VideoCode::wakeUp()
 {
-    QMutexLocker locker(&m_mutex);
-    m_isPlaying = isPlaying;
+    if (m_packetQueue) {
+        m_packetQueue->notifyAll();
+    }
+    m_videoDataQueue.notifyAll();
 }
 
-bool VideoCode::isPlaying()
+void VideoCode::flush()
 {
-    QMutexLocker locker(&m_mutex);
-    return m_isPlaying;
+    // 清空解码器缓冲区，确保从新位置开始解码
+    if (m_videoCodecContext) {
+        avcodec_flush_buffers(m_videoCodecContext);
+    }
+    if (m_pendingPacket) {
+        av_packet_free(&m_pendingPacket);
+    }
+    m_flushSent = false;
+    m_trickDrain = false;
+    m_packetsInFlight = 0;
+    m_lastPushedMs = -1;
+    m_seekTargetMs = -1;
+    m_decodeBusyNs = 0;
+    m_decodedFrames = 0;
 }
 
-int VideoCode::getDuration() const
+void VideoCode::syncSerial()
 {
-    if (!m_formatContext || m_formatContext->duration == AV_NOPTS_VALUE) {
-        return 0;
+    int serial = m_demuxer->getSerial();
+    if (serial == m_serial) {
+        return;
     }
-    // duration 单位是 AV_TIME_BASE (通常是微秒)
-    // 转换为秒：duration / AV_TIME_BASE
-    return static_cast<int>(m_formatContext->duration / AV_TIME_BASE);
+    // 解码器中缓存的旧位置的帧全部丢弃，从新位置的关键帧开始解码
+    flush();
+    m_serial = serial;
+    // 快进/快退时解码器丢弃非关键帧，显示的就是目标之前的关键帧，不按目标丢帧
+    m_trickPlay = m_demuxer->getTrickRate() != 0;
+    m_videoCodecContext->skip_frame = m_trickPlay ? AVDISCARD_NONKEY : AVDISCARD_DEFAULT;
+    // 退出快进/快退后由 applyFrameSkip() 重新应用跳帧级别
+    m_appliedSkipLevel = 0;
+    m_seekTargetMs = m_trickPlay ? -1 : m_demuxer->getSeekTarget();
 }
 
-void VideoCode::seekTo(int seconds)
+void VideoCode::setDecodeAheadLimit(qint64 maxBytes, qint64 maxAheadMs)
 {
-    if (!m_isOpened || !m_formatContext || m_videoStreamIndex < 0) {
-        qDebug() << "Cannot seek: video not opened";
-        return;
+    m_decodeBudget.setLimits(maxBytes, maxAheadMs);
+}
+
+void VideoCode::setDecodeThreading(int threadCount, DecodeThreadType type)
+{
+    m_threadCount = qBound(0, threadCount, VIDEO_DECODE_MAX_THREADS);
+    m_threadType = type;
+}
+
+void VideoCode::configureThreading(const AVCodec *codec)
+{
+    int threadCount = m_threadCount;
+    if (threadCount == 0) {
+        // 自动：小分辨率单线程就足够，多线程只会增加延迟和内存；大分辨率用满所有核
+        int cores = qMax(1, QThread::idealThreadCount());
+        int pixels = m_videoCodecContext->width * m_videoCodecContext->height;
+        if (pixels <= 640 * 480) {
+            threadCount = 1;
+        } else if (pixels <= 1280 * 720) {
+            threadCount = qMin(2, cores);
+        } else {
+            threadCount = cores;
+        }
+        threadCount = qMin(threadCount, VIDEO_DECODE_MAX_THREADS);
     }
 
-    // 将秒数转换为 AV_TIME_BASE 单位的时间戳
-    // AV_TIME_BASE 通常是 1000000 (微秒)
-    int64_t timestamp = static_cast<int64_t>(seconds) * AV_TIME_BASE;
-    
-    // 使用 av_seek_frame 跳转到指定位置
-    // 参数说明：
-    // - m_formatContext: 格式上下文
-    // - -1: 对所有流进行跳转（如果使用 -1，timestamp 必须是 AV_TIME_BASE 单位）
-    // - timestamp: 目标时间戳
-    // - AVSEEK_FLAG_BACKWARD: 向后查找最近的 keyframe（更安全）
-    int ret = av_seek_frame(m_formatContext, -1, timestamp, AVSEEK_FLAG_BACKWARD);
-    
-    if (ret < 0) {
-        qDebug() << "Failed to seek to position:" << seconds << "seconds";
+    bool frameCapable = codec->capabilities & AV_CODEC_CAP_FRAME_THREADS;
+    bool sliceCapable = codec->capabilities & AV_CODEC_CAP_SLICE_THREADS;
+    int threadType = 0;
+    switch (m_threadType) {
+    case DecodeThreadFrame:
+        threadType = frameCapable ? FF_THREAD_FRAME : FF_THREAD_SLICE;
+        break;
+    case DecodeThreadSlice:
+        threadType = sliceCapable ? FF_THREAD_SLICE : FF_THREAD_FRAME;
+        break;
+    default:
+        // 两者都允许时 libavcodec 优先使用帧级
+        threadType = FF_THREAD_FRAME | FF_THREAD_SLICE;
+        break;
+    }
+
+    m_videoCodecContext->thread_count = threadCount;
+    m_videoCodecContext->thread_type = threadType;
+}
+
+void VideoCode::accountDecodeTime(int64_t startNs, bool frameOutput)
+{
+    m_decodeBusyNs += steadyNowNs() - startNs;
+    if (!frameOutput) {
         return;
     }
-    
-    // 清空解码器缓冲区，确保从新位置开始解码
-    if (m_videoCodecContext) {
-        avcodec_flush_buffers(m_videoCodecContext);
+    ++m_decodedFrames;
+    if (m_decodeBusyNs >= (int64_t)VIDEO_DECODE_FPS_WINDOW_MS * 1000000) {
+        m_decodeFps.store(m_decodedFrames * 1e9 / m_decodeBusyNs, std::memory_order_relaxed);
+        m_decodeBusyNs = 0;
+        m_decodedFrames = 0;
     }
-    
-    // 清空视频数据队列，避免显示旧帧
-    m_videoDataQueue.clear();
-    
-    qDebug() << "Seeked to position:" << seconds << "seconds";
 }
 
-bool VideoCode::openVideo(const QString &filePath)
+bool VideoCode::openVideo(Demuxer *demuxer)
 {
     closeVideo(); // 先清理之前的资源
 
-    // 打开文件
-    if (avformat_open_input(&m_formatContext, filePath.toUtf8().constData(), nullptr, nullptr) < 0) {
-        qDebug() << "Failed to open video file:" << filePath;
-        return false;
-    }
-
-    if (avformat_find_stream_info(m_formatContext, nullptr) < 0) {
-        qDebug() << "Failed to find stream info";
-        return false;
-    }
-
-    // 查找视频流
-    m_videoStreamIndex = av_find_best_stream(m_formatContext, AVMEDIA_TYPE_VIDEO, -1, -1, nullptr, 0);
-    if (m_videoStreamIndex < 0) {
+    if (!demuxer || !demuxer->isOpened() || demuxer->getVideoStreamIndex() < 0) {
         qDebug() << "No video stream found";
         return false;
     }
+    m_demuxer = demuxer;
+    m_packetQueue = &demuxer->getVideoPacketQueue();
+    m_serial = demuxer->getSerial();
+    m_seekTargetMs = -1;
+    m_trickPlay = false;
 
-    m_videoStream = m_formatContext->streams[m_videoStreamIndex];
-    AVCodecParameters *videoParams = m_formatContext->streams[m_videoStreamIndex]->codecpar;
+    m_videoStream = demuxer->getVideoStream();
+    AVCodecParameters *videoParams = m_videoStream->codecpar;
     const AVCodec *videoCodec = avcodec_find_decoder(videoParams->codec_id);
     
     if (!videoCodec) {
@@ -126,25 +192,17 @@ bool VideoCode::openVideo(const QString &filePath)
         return false;
     }
 
+    configureThreading(videoCodec);
+
     if (avcodec_open2(m_videoCodecContext, videoCodec, nullptr) < 0) {
         qDebug() << "Failed to open video codec";
         return false;
     }
-    
-    // 初始化图像转换
-    m_swsContext = sws_getContext(
-        m_videoCodecContext->width, m_videoCodecContext->height, m_videoCodecContext->pix_fmt,
-        m_videoCodecContext->width, m_videoCodecContext->height, AV_PIX_FMT_RGB24,
-        SWS_BICUBIC, nullptr, nullptr, nullptr
-    );
-
-    if (!m_swsContext) {
-        qDebug() << "Failed to initialize sws context";
-        return false;
-    }
+    qDebug() << "Video decode threads:" << m_videoCodecContext->thread_count
+             << (isFrameThreading() ? "frame" : "slice");
 
     // 获取视频帧率
-    m_videoFps = av_q2d(m_formatContext->streams[m_videoStreamIndex]->avg_frame_rate);
+    m_videoFps = av_q2d(m_videoStream->avg_frame_rate);
     if (m_videoFps <= 0) {
         // 如果无法获取帧率，使用默认值
         m_videoFps = 30.0;
@@ -153,11 +211,10 @@ bool VideoCode::openVideo(const QString &filePath)
     qDebug() << "Video resolution: " << m_videoCodecContext->width << "x" << m_videoCodecContext->height;
 
     // 分配内存
-    m_packet = av_packet_alloc();
     m_videoFrame = av_frame_alloc();
 
-    if (!m_packet || !m_videoFrame) {
-        qDebug() << "Failed to allocate packet or frame";
+    if (!m_videoFrame) {
+        qDebug() << "Failed to allocate frame";
         return false;
     }
 
@@ -170,66 +227,229 @@ bool VideoCode::getNextFrame()
 {
     if (!m_isOpened) return false;
 
-    while (av_read_frame(m_formatContext, m_packet) >= 0) {
-        if (m_packet->stream_index == m_videoStreamIndex) {
-            // 解码视频
-            if (avcodec_send_packet(m_videoCodecContext, m_packet) >= 0) {
-                if (avcodec_receive_frame(m_videoCodecContext, m_videoFrame) == 0) {
-                    // 转换为RGB
-                    uint8_t *rgbBuffer = new uint8_t[m_videoCodecContext->width * m_videoCodecContext->height * 3];
-                    uint8_t *rgbData[4] = {rgbBuffer, nullptr, nullptr, nullptr};
-                    int rgbLinesize[4] = {m_videoCodecContext->width * 3, 0, 0, 0};
-
-                    sws_scale(m_swsContext, m_videoFrame->data, m_videoFrame->linesize,
-                             0, m_videoCodecContext->height, rgbData, rgbLinesize);
-
-                    // 创建QImage并立即复制数据，避免引用已释放的内存
-                    QImage image(rgbBuffer, m_videoCodecContext->width, m_videoCodecContext->height, 
-                               m_videoCodecContext->width * 3, QImage::Format_RGB888);
-                    // 创建深拷贝，确保数据安全
-                    VideoData videoData;
-                    videoData.image = image.copy();
-                    delete[] rgbBuffer;
-                    if (m_videoFrame->pts != AV_NOPTS_VALUE) {
-                        videoData.timestamp = av_rescale_q(m_videoFrame->pts, 
-                                                           m_videoStream->time_base, 
-                                                           AV_TIME_BASE_Q) / 1000; // 转换为毫秒
-                    } else {
-                        videoData.timestamp = 0;
-                    }
-                    m_videoDataQueue.push(videoData);
-                    av_packet_unref(m_packet);
-                    return true; // 视频帧解码成功，返回true
-                }
+    syncSerial();
+
+    // 先取出解码器中已就绪的帧，一个数据包可能产生多帧，B帧/帧级多线程时解码器还会缓存多帧
+    // 帧级多线程时 receive 会阻塞到工作线程解出该帧，这段时间也计入解码耗时
+    int64_t startNs = steadyNowNs();
+    int ret = avcodec_receive_frame(m_videoCodecContext, m_videoFrame);
+    if (ret == 0) {
+        if (m_packetsInFlight > 0) {
+            --m_packetsInFlight;
+        }
+        // 跳转后从关键帧开始解码，目标之前的帧只用作参考，不进入输出队列
+        // 已落后主时钟的帧显示出来也是迟到的，在颜色转换之前就丢弃
+        if (!isBeforeSeekTarget(m_videoFrame)) {
+            if (isLate(m_videoFrame)) {
+                m_droppedFrames.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                pushFrame(m_videoFrame);
             }
         }
-        av_packet_unref(m_packet);
+        av_frame_unref(m_videoFrame);
+        accountDecodeTime(startNs, true);
+        return true;
+    }
+    accountDecodeTime(startNs, false);
+    if (ret == AVERROR_EOF) {
+        if (m_trickDrain) {
+            // 当前关键帧已输出，复位解码器接收下一个关键帧
+            avcodec_flush_buffers(m_videoCodecContext);
+            m_trickDrain = false;
+            return true;
+        }
+        // 冲刷完成，最后几帧也已输出
+        return false;
+    }
+    if (ret != AVERROR(EAGAIN)) {
+        qDebug() << "Failed to receive video frame:" << ret;
     }
 
-    return false; // 文件结束
+    // 没有可取的帧时才送入新的数据包
+    return sendNextPacket();
+}
+
+bool VideoCode::sendNextPacket()
+{
+    if (!m_pendingPacket) {
+        if (m_flushSent) {
+            return false;
+        }
+        int serial = 0;
+        if (!m_packetQueue->pop(m_pendingPacket, &serial)) {
+            if (m_demuxer->isEof() && m_packetQueue->empty()) {
+                // 文件结束：送入空包进入冲刷模式，之后 receive 依次返回缓存的帧和 EOF
+                avcodec_send_packet(m_videoCodecContext, nullptr);
+                m_flushSent = true;
+                return true;
+            }
+            // 包队列为空，挂起等待下一个包
+            m_packetQueue->waitPop(m_pendingPacket, VIDEO_DECODE_WAIT_TIMEOUT_MS, &serial);
+            if (!m_pendingPacket) {
+                return true;
+            }
+        }
+        if (serial > m_serial) {
+            // 解复用器先发布序号再入队，新跳转的数据包可能先于 syncSerial() 被取到：
+            // 先切换到新序号（冲刷会释放 m_pendingPacket，先取下），再送入该包
+            AVPacket *packet = m_pendingPacket;
+            m_pendingPacket = nullptr;
+            syncSerial();
+            m_pendingPacket = packet;
+        }
+        if (serial != m_serial) {
+            // 跳转前读到的旧数据包（或已被更新的跳转取代），不送入解码器
+            av_packet_free(&m_pendingPacket);
+            return true;
+        }
+    }
+
+    applyFrameSkip();
+    int64_t startNs = steadyNowNs();
+    int ret = avcodec_send_packet(m_videoCodecContext, m_pendingPacket);
+    accountDecodeTime(startNs, false);
+    if (ret == AVERROR(EAGAIN)) {
+        // 解码器输入已满，保留该包，下一轮先取出输出帧
+        return true;
+    }
+    if (ret < 0) {
+        qDebug() << "Failed to send video packet:" << ret;
+    } else if (!m_trickPlay) {
+        accountSkippedFrames();
+    } else {
+        // 关键帧之间不连续，立即冲刷取出该帧，不等重排序和帧级多线程的输出延迟
+        avcodec_send_packet(m_videoCodecContext, nullptr);
+        m_trickDrain = true;
+    }
+    av_packet_free(&m_pendingPacket);
+    return true;
+}
+
+bool VideoCode::isBeforeSeekTarget(const AVFrame *frame)
+{
+    if (m_seekTargetMs < 0) {
+        return false;
+    }
+    if (frame->pts == AV_NOPTS_VALUE) {
+        // 没有时间戳无法判断位置，放弃精确跳转
+        m_seekTargetMs = -1;
+        return false;
+    }
+    // 帧的显示区间 [pts, pts + duration) 覆盖目标时间时显示该帧
+    qint64 startMs = av_rescale_q(frame->pts, m_videoStream->time_base, AVRational{1, 1000});
+    qint64 durationMs = frame->duration > 0
+            ? av_rescale_q(frame->duration, m_videoStream->time_base, AVRational{1, 1000})
+            : static_cast<qint64>(1000 / m_videoFps);
+    if (startMs + durationMs <= m_seekTargetMs) {
+        return true;
+    }
+    m_seekTargetMs = -1;
+    return false;
+}
+
+void VideoCode::applyFrameSkip()
+{
+    // 快进/快退时固定只解码关键帧
+    if (m_trickPlay) {
+        return;
+    }
+    int level = m_frameSkipLevel.load(std::memory_order_relaxed);
+    if (level == m_appliedSkipLevel) {
+        return;
+    }
+    static const AVDiscard discards[VIDEO_FRAME_SKIP_MAX_LEVEL + 1] = {
+        AVDISCARD_DEFAULT, AVDISCARD_NONREF, AVDISCARD_BIDIR
+    };
+    // 帧级多线程时新值随下一个数据包同步到工作线程，不需要冲刷解码器
+    m_videoCodecContext->skip_frame = discards[level];
+    m_appliedSkipLevel = level;
+    qDebug() << "Video frame skip level:" << level;
+}
+
+void VideoCode::accountSkippedFrames()
+{
+    // 解码器正常最多缓存 重排序深度 + 帧级多线程延迟 个数据包不出帧，超出的部分是被跳过的帧
+    ++m_packetsInFlight;
+    int maxInFlight = m_videoCodecContext->has_b_frames + getDecodeDelayFrames() + 1;
+    if (m_packetsInFlight <= maxInFlight) {
+        return;
+    }
+    if (m_appliedSkipLevel > 0) {
+        m_droppedFrames.fetch_add(m_packetsInFlight - maxInFlight, std::memory_order_relaxed);
+    }
+    m_packetsInFlight = maxInFlight;
+}
+
+bool VideoCode::isLate(const AVFrame *frame)
+{
+    qint64 clockMs = m_masterClockMs.load(std::memory_order_relaxed);
+    if (clockMs < 0 || m_trickPlay || frame->pts == AV_NOPTS_VALUE) {
+        return false;
+    }
+    qint64 ptsMs = av_rescale_q(frame->pts, m_videoStream->time_base, AVRational{1, 1000});
+    if (ptsMs + VIDEO_LATE_DROP_MS >= clockMs) {
+        return false;
+    }
+    // 解码一直跟不上时每隔一段媒体时间仍送出一帧，画面不会停住
+    return m_lastPushedMs >= 0 && ptsMs - m_lastPushedMs < VIDEO_LATE_MAX_GAP_MS;
+}
+
+void VideoCode::pushFrame(AVFrame *frame)
+{
+    // 只转移帧的引用，不拷贝像素，也不做颜色转换
+    VideoData videoData;
+    videoData.serial = m_serial;
+    AVFrame *ref = av_frame_alloc();
+    if (!ref) {
+        return;
+    }
+    av_frame_move_ref(ref, frame);
+    videoData.frame.reset(ref, [](AVFrame *p) { av_frame_free(&p); });
+
+    if (ref->pts != AV_NOPTS_VALUE) {
+        videoData.timestamp = av_rescale_q(ref->pts,
+                                           m_videoStream->time_base,
+                                           AV_TIME_BASE_Q) / 1000; // 转换为毫秒
+    } else {
+        videoData.timestamp = 0;
+    }
+    // 按帧实际占用的缓冲区计入预算
+    qint64 bytes = 0;
+    for (int i = 0; i < AV_NUM_DATA_POINTERS && ref->buf[i]; ++i) {
+        bytes += ref->buf[i]->size;
+    }
+    qint64 timestamp = videoData.timestamp;
+    if (m_videoDataQueue.push(std::move(videoData))) {
+        m_decodeBudget.onPush(bytes, timestamp);
+        m_lastPushedMs = timestamp;
+    }
 }
 
 void VideoCode::run()
 {
     qDebug() << "VideoCode run";
-    setPlaying(true);
-    while (true) {
-        if (!m_isOpened) {
-            break;
-        }
-        if (!isPlaying()) {
-            break;
+    while (m_isOpened && !m_playerState->quitRequested()) {
+        if (!m_playerState->isActive()) {
+            // 暂停或播放结束：挂起到状态变化，不退出线程
+            m_playerState->waitActive(WaitEvent::toTimeoutUs(VIDEO_DECODE_WAIT_TIMEOUT_MS));
+            continue;
         }
-        if (m_videoDataQueue.size() >= MAX_VIDEO_BUFFER_SIZE) {
-            msleep(1);
+        // 按内存和时长预算限流，而不是按帧数；快进/快退时关键帧时间跨度大，按帧数限流
+        bool overBudget = m_trickPlay ? m_videoDataQueue.size() >= VIDEO_TRICK_PLAY_AHEAD_FRAMES
+                                      : m_decodeBudget.isOverBudget(m_videoDataQueue.size());
+        if (m_videoDataQueue.full() || overBudget) {
+            // 挂起到消费者取走数据为止
+            m_videoDataQueue.waitForPop(VIDEO_DECODE_WAIT_TIMEOUT_MS);
             continue;
         }
         if (!getNextFrame()) {
-            break;
+            // 已解码到文件末尾，挂起等待跳转后的新数据包
+            m_drainedSerial.store(m_serial, std::memory_order_release);
+            m_packetQueue->waitForData(VIDEO_DECODE_WAIT_TIMEOUT_MS);
         }
     }
     qDebug() << "VideoCode run end";
-    // 注意：暂停时不要closeVideo，只有停止时才关闭
+    // 注意：暂停时线程挂起而不退出，只有关闭文件时才退出
 }
 
 void VideoCode::closeVideo()
@@ -240,26 +460,23 @@ void VideoCode::closeVideo()
 
 void VideoCode::cleanup()
 {
-    if (m_swsContext) {
-        sws_freeContext(m_swsContext);
-        m_swsContext = nullptr;
-    }
-    
-    if (m_packet) {
-        av_packet_free(&m_packet);
-    }
-    
     if (m_videoFrame) {
         av_frame_free(&m_videoFrame);
     }
+
+    if (m_pendingPacket) {
+        av_packet_free(&m_pendingPacket);
+    }
+    m_flushSent = false;
+    m_trickDrain = false;
     
     if (m_videoCodecContext) {
         avcodec_free_context(&m_videoCodecContext);
     }
-    
-    if (m_formatContext) {
-        avformat_close_input(&m_formatContext);
-    }
-    
+
+
+    m_demuxer = nullptr;
+    m_packetQueue = nullptr;
+    m_videoStream = nullptr;
     m_videoFps = 0.0;
 }
@@ -2,79 +2,194 @@
 #define VIDEOCODE_H
 
 #include <QObject>
-#include <QImage>
 #include <QThread>
-#include <QMutex>
+#include <atomic>
+#include <cstdint>
+#include <memory>
 #include "../models/SPSCLockFreeQueue.h"
+#include "../models/DecodeBudget.h"
+#include "../models/PlayerState.h"
+#include "Demuxer.h"
 
 extern "C" {
 #include <libavformat/avformat.h>
 #include <libavcodec/avcodec.h>
 #include <libavutil/avutil.h>
-#include <libswscale/swscale.h>
 }
 
-#define MAX_VIDEO_BUFFER_SIZE 64 
-
+#define MAX_VIDEO_BUFFER_SIZE 64 // 队列槽位数，仅作为硬上限
+#define VIDEO_DECODE_AHEAD_BYTES (96 * 1024 * 1024) // 预解码内存预算 96MB
+#define VIDEO_DECODE_AHEAD_MS 500 // 预解码时长预算 500ms
+#define VIDEO_DECODE_WAIT_TIMEOUT_MS 100 // 队列空/超出预算时单次等待的最长时间
+#define VIDEO_DECODE_MAX_THREADS 16 // 解码线程数上限，帧级多线程的输出延迟随线程数线性增加
+#define VIDEO_DECODE_FPS_WINDOW_MS 1000 // 解码速度统计窗口（按解码耗时累计）
+#define VIDEO_LATE_DROP_MS 100 // 解码出的帧已落后主时钟超过该时长时直接丢弃，不进入输出队列
+#define VIDEO_LATE_MAX_GAP_MS 500 // 丢弃落后帧时两次输出之间最多间隔的媒体时长，画面不会完全停住
+#define VIDEO_FRAME_SKIP_MAX_LEVEL 2 // 跳帧级别上限：0 不跳，1 跳过非参考帧，2 跳过所有B帧
+#define VIDEO_TRICK_PLAY_AHEAD_FRAMES 4 // 快进/快退时最多预解码的关键帧数，关键帧间隔大，不按时长预算
+
+// 已解码帧的引用，像素仍是解码器输出的原始格式，显示前才由 VideoConverter 转换
 struct VideoData
 {
-    QImage image;
+    std::shared_ptr<AVFrame> frame;
     qint64 timestamp;
+    // 解码该帧时的跳转序号，渲染线程丢弃不属于最新跳转请求的帧
+    int serial;
 
     // 默认构造函数
-    VideoData() : image(QImage()), timestamp(-1) {}
+    VideoData() : frame(), timestamp(-1), serial(0) {}
 };
 
+// 阻塞模式队列：队列空/满时挂起线程而不是轮询
+typedef SPSCLockFreeQueue<VideoData, MAX_VIDEO_BUFFER_SIZE, true> VideoDataQueue;
+
 class VideoCode : public QThread
 {
     Q_OBJECT
 
 public:
+    // 解码器多线程方式
+    enum DecodeThreadType {
+        DecodeThreadAuto,   // 解码器支持帧级多线程时使用帧级，否则使用片级
+        DecodeThreadFrame,  // 帧级：多帧并行解码，输出延迟增加 线程数-1 帧
+        DecodeThreadSlice   // 片级：同一帧的多个片并行解码，不增加延迟，但依赖码流按多片编码
+    };
+
     explicit VideoCode(QObject *parent = nullptr);
     ~VideoCode();
 
-    bool openVideo(const QString &filePath);
+    // 从解复用器的视频包队列解码，文件由 Demuxer 统一打开
+    bool openVideo(Demuxer *demuxer);
     void closeVideo();
+    // 解码状态机推进一步：取出一帧已解码的帧，或送入一个数据包；解码器冲刷完毕返回 false
     bool getNextFrame();
 
-    void setPlaying(bool isPlaying);
-    bool isPlaying();
+    // 设置共享的播放器状态（不持有），start() 之前调用
+    void setPlayerState(PlayerState *playerState) { m_playerState = playerState; }
+    // 唤醒挂起在输入/输出队列上的解码线程，让它重新检查状态
+    void wakeUp();
+    // 已解码到文件末尾时的跳转序号，与最新跳转序号相同表示该位置之后的帧已全部输出
+    int getDrainedSerial() const { return m_drainedSerial.load(std::memory_order_acquire); }
+
+    /**
+     * @brief 设置解码器多线程策略，在 openVideo() 之前调用，下次打开时生效
+     * @param threadCount 线程数，0 表示按分辨率和CPU核数自动选择，1 表示单线程
+     * @param type 多线程方式，解码器不支持时自动回退
+     */
+    void setDecodeThreading(int threadCount, DecodeThreadType type = DecodeThreadAuto);
+    // 解码器实际使用的线程数和方式（打开后有效）
+    int getDecodeThreadCount() const { return m_videoCodecContext ? m_videoCodecContext->thread_count : 0; }
+    bool isFrameThreading() const { return m_videoCodecContext && (m_videoCodecContext->active_thread_type & FF_THREAD_FRAME); }
+    // 帧级多线程带来的额外输出延迟（帧数）
+    int getDecodeDelayFrames() const { return isFrameThreading() ? getDecodeThreadCount() - 1 : 0; }
+    // 解码吞吐量（帧/秒），只统计解码耗时，不含等待时间，因此不受播放速度和预算限流影响
+    double getDecodeFps() const { return m_decodeFps.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief 设置跳帧级别，解码跟不上主时钟时由渲染线程调整，任意线程调用
+     *
+     * 0 正常解码；1 跳过非参考帧（AVDISCARD_NONREF）；2 跳过所有B帧（AVDISCARD_BIDIR）。
+     * 被跳过的帧不会被其他帧参考，画面不会花屏，只降低帧率。快进/快退时不生效。
+     */
+    void setFrameSkipLevel(int level) { m_frameSkipLevel.store(qBound(0, level, VIDEO_FRAME_SKIP_MAX_LEVEL)); }
+    int getFrameSkipLevel() const { return m_frameSkipLevel.load(); }
+    /**
+     * @brief 设置主时钟（毫秒），解码出的帧落后超过 VIDEO_LATE_DROP_MS 时直接丢弃
+     *
+     * 由渲染线程在音频时钟建立后持续更新，-1 表示时钟未知（暂停、跳转中），此时不丢帧。
+     */
+    void setMasterClock(qint64 clockMs) { m_masterClockMs.store(clockMs, std::memory_order_relaxed); }
+    // 解码端丢弃的帧数：解码器按跳帧级别跳过的帧（估算）加上解码后已落后而丢弃的帧
+    quint64 getDroppedFrames() const { return m_droppedFrames.load(std::memory_order_relaxed); }
 
     double getVideoFps() const { return m_videoFps; }
     int getWidth() const { return m_videoCodecContext ? m_videoCodecContext->width : 0; }
     int getHeight() const { return m_videoCodecContext ? m_videoCodecContext->height : 0; }
-    int getDuration() const;  // 返回总时长（秒）
 
-    // 跳转到指定时间，单位为秒
-    void seekTo(int seconds);
 
-    SPSCLockFreeQueue<VideoData, MAX_VIDEO_BUFFER_SIZE> &getVideoDataQueue() { return m_videoDataQueue; }
+    // 设置预解码预算，<= 0 表示对应项不限制
+    void setDecodeAheadLimit(qint64 maxBytes, qint64 maxAheadMs);
+    // 已解码未显示的字节数和时长（解码线程最近一次检查预算时的值，任意线程可调用）
+    qint64 getQueuedBytes() const { return m_decodeBudget.publishedBytes(); }
+    qint64 getQueuedDurationMs() const { return m_decodeBudget.publishedDurationMs(); }
+
+    VideoDataQueue &getVideoDataQueue() { return m_videoDataQueue; }
 
 
 private:
     void run() override;
     void cleanup();
+    // 解复用器完成跳转后冲刷解码器，并取得跳转目标（仅由解码线程调用）
+    void syncSerial();
+    // 清空解码器缓冲区；已输出的旧帧由渲染线程按序号丢弃
+    void flush();
+    // 送入下一个数据包，文件结束时送入空包冲刷解码器；丢弃跳转前的旧数据包
+    bool sendNextPacket();
+    // 把解码帧的引用移入输出队列
+    void pushFrame(AVFrame *frame);
+    // 帧是否已落后主时钟，应在进入输出队列之前丢弃
+    bool isLate(const AVFrame *frame);
+    // 把渲染线程设置的跳帧级别应用到解码器（仅由解码线程调用）
+    void applyFrameSkip();
+    // 送入一个数据包后估算解码器按跳帧级别跳过的帧数
+    void accountSkippedFrames();
+    // 帧是否在跳转目标之前，到达目标后清除跳转目标
+    bool isBeforeSeekTarget(const AVFrame *frame);
+    // 按策略配置解码器线程数和方式，在 avcodec_open2 之前调用
+    void configureThreading(const AVCodec *codec);
+    // 累计一次解码步骤的耗时，输出帧时更新解码速度
+    void accountDecodeTime(int64_t startNs, bool frameOutput);
     
+    // 解复用器（不持有）
+    Demuxer *m_demuxer;
+    PacketQueue *m_packetQueue;
+
     // FFmpeg核心变量
-    AVFormatContext *m_formatContext;
     AVCodecContext *m_videoCodecContext;
-    SwsContext *m_swsContext;
-    
-    int m_videoStreamIndex;
     
-    AVPacket *m_packet;
     AVFrame *m_videoFrame;
     AVStream *m_videoStream;
+    // 解码器暂不接收（EAGAIN）而保留的数据包
+    AVPacket *m_pendingPacket;
+    // 是否已送入冲刷用的空包
+    bool m_flushSent;
+    // 快进/快退：只解码关键帧，每个关键帧送入后立即冲刷，解码器中不缓存帧
+    bool m_trickPlay;
+    // 快进/快退时已为当前关键帧送入空包，冲刷完成后复位解码器继续接收数据包
+    bool m_trickDrain;
+    // 跳帧：渲染线程设置的级别和解码器当前使用的级别
+    std::atomic<int> m_frameSkipLevel;
+    int m_appliedSkipLevel;
+    // 已送入解码器、尚未输出帧的数据包数，超出解码器正常缓存深度的部分视为被跳过
+    int m_packetsInFlight;
+    // 主时钟和最近一次送出的帧的时间戳（毫秒），用于丢弃落后的帧
+    std::atomic<qint64> m_masterClockMs;
+    qint64 m_lastPushedMs;
+    std::atomic<quint64> m_droppedFrames;
     bool m_isOpened;
+    // 当前解码数据所属的跳转序号和跳转目标（毫秒），目标为 -1 表示已到达或没有跳转
+    int m_serial;
+    qint64 m_seekTargetMs;
 
     // 视频帧率
     double m_videoFps;
+
+    // 解码器多线程策略
+    int m_threadCount;
+    DecodeThreadType m_threadType;
+
+    // 解码速度统计，由解码线程维护
+    int64_t m_decodeBusyNs;
+    int m_decodedFrames;
+    std::atomic<double> m_decodeFps;
     
-    // 播放状态
-    bool m_isPlaying;
-    QMutex m_mutex;
+    // 播放器状态（不持有），暂停时挂起，要求退出时结束 run()
+    PlayerState *m_playerState;
+    std::atomic<int> m_drainedSerial;
 
-    SPSCLockFreeQueue<VideoData, MAX_VIDEO_BUFFER_SIZE> m_videoDataQueue;
+    VideoDataQueue m_videoDataQueue;
+    // 预解码预算，由解码线程（生产者）维护
+    DecodeBudget<MAX_VIDEO_BUFFER_SIZE> m_decodeBudget;
 };
 
 #endif // VIDEOCODE_H
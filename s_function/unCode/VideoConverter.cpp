@@ -0,0 +1,96 @@
+#include "VideoConverter.h"
+#include <QDebug>
+
+VideoConverter::VideoConverter()
+    : m_swsContext(nullptr)
+    , m_requestWidth(0)
+    , m_requestHeight(0)
+    , m_outputWidth(0)
+    , m_outputHeight(0)
+    , m_framePool(FramePool::create())
+{
+
+}
+
+VideoConverter::~VideoConverter()
+{
+    reset();
+}
+
+void VideoConverter::setOutputSize(int width, int height)
+{
+    m_requestWidth.store(qMax(0, width), std::memory_order_relaxed);
+    m_requestHeight.store(qMax(0, height), std::memory_order_relaxed);
+}
+
+void VideoConverter::updateOutputSize(int srcWidth, int srcHeight)
+{
+    int width = srcWidth;
+    int height = srcHeight;
+    int requestWidth = m_requestWidth.load(std::memory_order_relaxed);
+    int requestHeight = m_requestHeight.load(std::memory_order_relaxed);
+    if (requestWidth > 0 && requestHeight > 0) {
+        // 与显示端一样拉伸到显示区域，只是提前在转换时完成缩小
+        width = qMin(requestWidth, srcWidth);
+        height = qMin(requestHeight, srcHeight);
+    }
+
+    if (width * height > m_outputWidth * m_outputHeight) {
+        // 输出变大后池中的空闲缓冲区都放不下，提前释放
+        m_framePool->clear();
+    }
+    m_outputWidth = width;
+    m_outputHeight = height;
+}
+
+bool VideoConverter::updateScaler(int srcWidth, int srcHeight, AVPixelFormat srcFormat)
+{
+    // 参数与上次相同时 sws_getCachedContext 直接返回原上下文
+    // AV_PIX_FMT_RGB32 是本机字节序的 0xAARRGGBB，与 QImage::Format_RGB32 一致
+    m_swsContext = sws_getCachedContext(m_swsContext,
+        srcWidth, srcHeight, srcFormat,
+        m_outputWidth, m_outputHeight, AV_PIX_FMT_RGB32,
+        SWS_BICUBIC, nullptr, nullptr, nullptr);
+    return m_swsContext != nullptr;
+}
+
+QImage VideoConverter::convert(const AVFrame *frame)
+{
+    if (!frame || frame->width <= 0 || frame->height <= 0) {
+        return QImage();
+    }
+    updateOutputSize(frame->width, frame->height);
+
+    // 从缓冲池取出图像，直接写入池中的像素内存，无需再拷贝
+    QImage image = m_framePool->acquire(m_outputWidth, m_outputHeight, QImage::Format_RGB32);
+    if (image.isNull()) {
+        return QImage();
+    }
+
+    if (YuvConverter::isSupported(frame->format)) {
+        m_yuvConverter.convert(frame, image.bits(), static_cast<int>(image.bytesPerLine()),
+                               m_outputWidth, m_outputHeight);
+        return image;
+    }
+
+    if (!updateScaler(frame->width, frame->height, static_cast<AVPixelFormat>(frame->format))) {
+        qDebug() << "Failed to update sws context";
+        return QImage();
+    }
+    uint8_t *rgbData[4] = {image.bits(), nullptr, nullptr, nullptr};
+    int rgbLinesize[4] = {static_cast<int>(image.bytesPerLine()), 0, 0, 0};
+
+    sws_scale(m_swsContext, frame->data, frame->linesize,
+             0, frame->height, rgbData, rgbLinesize);
+    return image;
+}
+
+void VideoConverter::reset()
+{
+    if (m_swsContext) {
+        sws_freeContext(m_swsContext);
+        m_swsContext = nullptr;
+    }
+    m_outputWidth = 0;
+    m_outputHeight = 0;
+}
@@ -0,0 +1,78 @@
+#ifndef VIDEOCONVERTER_H
+#define VIDEOCONVERTER_H
+
+#include <QImage>
+#include <atomic>
+#include <memory>
+#include "FramePool.h"
+#include "YuvConverter.h"
+
+extern "C" {
+#include <libavutil/frame.h>
+#include <libswscale/swscale.h>
+}
+
+/**
+ * @brief 把解码帧转换为显示用的 RGB 图像
+ *
+ * 解码线程只输出 AVFrame 引用，只有被选中显示的帧才经过这里转换，
+ * 跳转清空、迟到丢弃的帧不再白白做颜色转换和缩放。
+ * 输出图像为 QImage::Format_RGB32，从帧缓冲池借出，显示后自动归还。
+ * 常见格式由 YuvConverter 的 SIMD 内核转换，其他格式回退到 swscale。
+ *
+ * 注意事项：
+ * - convert()/reset() 只能由同一个线程调用（通常是渲染线程）
+ * - setOutputSize() 可以由任意线程调用，下一次 convert() 生效
+ */
+class VideoConverter
+{
+public:
+    VideoConverter();
+    ~VideoConverter();
+
+    VideoConverter(const VideoConverter &) = delete;
+    VideoConverter &operator=(const VideoConverter &) = delete;
+
+    /**
+     * @brief 设置输出图像尺寸
+     * @param width/height 显示区域的物理像素尺寸，<= 0 表示按原始分辨率输出
+     * @note 只缩小不放大：显示区域大于原始分辨率时仍按原始分辨率输出，由显示端放大
+     */
+    void setOutputSize(int width, int height);
+
+    /**
+     * @brief 转换一帧
+     * @return 转换后的图像，失败返回空 QImage
+     */
+    QImage convert(const AVFrame *frame);
+
+    /**
+     * @brief 释放转换上下文（关闭视频时调用）
+     */
+    void reset();
+
+    // 帧缓冲池命中/未命中次数，稳定播放时未命中次数不再增长
+    quint64 getFramePoolHitCount() const { return m_framePool->hitCount(); }
+    quint64 getFramePoolMissCount() const { return m_framePool->missCount(); }
+
+private:
+    // 按源尺寸和显示端请求计算输出尺寸
+    void updateOutputSize(int srcWidth, int srcHeight);
+    // swscale 回退路径：按源格式和当前输出尺寸更新转换上下文，参数不变时直接复用
+    bool updateScaler(int srcWidth, int srcHeight, AVPixelFormat srcFormat);
+
+    YuvConverter m_yuvConverter;
+    SwsContext *m_swsContext;
+
+    // 显示端请求的输出尺寸，任意线程写入
+    std::atomic<int> m_requestWidth;
+    std::atomic<int> m_requestHeight;
+    // 当前转换上下文的输出尺寸
+    int m_outputWidth;
+    int m_outputHeight;
+
+    // 帧缓冲池，输出图像从这里借出，显示后自动归还
+    std::shared_ptr<FramePool> m_framePool;
+};
+
+#endif // VIDEOCONVERTER_H
@@ -0,0 +1,638 @@
+#include "YuvConverter.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+extern "C" {
+#include <libavutil/pixfmt.h>
+}
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define YUV_CONVERTER_X86 1
+#include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#define YUV_CONVERTER_NEON 1
+#include <arm_neon.h>
+#endif
+
+// 插值权重的小数位数
+#define YUV_WEIGHT_BITS 7
+#define YUV_WEIGHT_ONE (1 << YUV_WEIGHT_BITS)
+// 行缓冲末尾的余量，SIMD 内核整块读取时可能越过有效数据
+#define YUV_ROW_PADDING 64
+
+namespace {
+
+/**
+ * 颜色矩阵系数，按 2^13 定点化。
+ * 计算方式与 SSE2 的 _mm_mulhi_epi16 一致：输入先左移 6 位，乘积取高 16 位，
+ * 结果带 3 位小数，四舍五入后截断到 [0, 255]。各实现的结果逐位相同。
+ */
+struct YuvCoefficients {
+    int16_t yOffset;
+    int16_t y;
+    int16_t rv;
+    int16_t gu;
+    int16_t gv;
+    int16_t bu;
+};
+
+YuvCoefficients makeCoefficients(double kr, double kb, bool fullRange)
+{
+    double kg = 1.0 - kr - kb;
+    double yScale = fullRange ? 1.0 : 255.0 / 219.0;
+    double cScale = fullRange ? 1.0 : 255.0 / 224.0;
+    YuvCoefficients c;
+    c.yOffset = fullRange ? 0 : 16;
+    c.y = (int16_t)lrint(yScale * 8192.0);
+    c.rv = (int16_t)lrint(2.0 * (1.0 - kr) * cScale * 8192.0);
+    c.gu = (int16_t)lrint(2.0 * (1.0 - kb) * kb / kg * cScale * 8192.0);
+    c.gv = (int16_t)lrint(2.0 * (1.0 - kr) * kr / kg * cScale * 8192.0);
+    c.bu = (int16_t)lrint(2.0 * (1.0 - kb) * cScale * 8192.0);
+    return c;
+}
+
+const YuvCoefficients &selectCoefficients(const AVFrame *frame)
+{
+    static const YuvCoefficients bt601Limited = makeCoefficients(0.299, 0.114, false);
+    static const YuvCoefficients bt601Full = makeCoefficients(0.299, 0.114, true);
+    static const YuvCoefficients bt709Limited = makeCoefficients(0.2126, 0.0722, false);
+    static const YuvCoefficients bt709Full = makeCoefficients(0.2126, 0.0722, true);
+
+    bool fullRange = frame->color_range == AVCOL_RANGE_JPEG || frame->format == AV_PIX_FMT_YUVJ420P;
+    bool bt709;
+    switch (frame->colorspace) {
+    case AVCOL_SPC_BT709:
+        bt709 = true;
+        break;
+    case AVCOL_SPC_BT470BG:
+    case AVCOL_SPC_SMPTE170M:
+        bt709 = false;
+        break;
+    default:
+        // 未标注时按分辨率推断：高清用 BT.709，标清用 BT.601
+        bt709 = frame->height >= 720;
+        break;
+    }
+    if (bt709) {
+        return fullRange ? bt709Full : bt709Limited;
+    }
+    return fullRange ? bt601Full : bt601Limited;
+}
+
+typedef void (*ConvertRowFunc)(const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                               uint32_t *dst, int count, const YuvCoefficients &c);
+typedef void (*LerpRowFunc)(const uint8_t *a, const uint8_t *b, uint8_t *dst, int count, int weight);
+typedef void (*LerpRow10Func)(const uint16_t *a, const uint16_t *b, uint8_t *dst, int count, int weight);
+typedef void (*ResampleRowFunc)(const uint8_t *src, int step, int srcCount, uint8_t *dst, int count,
+                                const int32_t *index, const uint8_t *weight);
+typedef void (*UpsampleRowFunc)(const uint8_t *src, int step, int srcCount, uint8_t *dst, int count,
+                                const int32_t *index, const uint8_t *weight);
+
+struct YuvKernels {
+    ConvertRowFunc convertRow;
+    LerpRowFunc lerpRow;
+    LerpRow10Func lerpRow10;
+    ResampleRowFunc resampleRow;
+    UpsampleRowFunc upsampleRow;
+    const char *name;
+};
+
+inline int clampByte(int value)
+{
+    return value < 0 ? 0 : (value > 255 ? 255 : value);
+}
+
+// 标量实现，同时用于 SIMD 实现处理尾部像素
+void convertRowScalar(const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                      uint32_t *dst, int count, const YuvCoefficients &c)
+{
+    for (int i = 0; i < count; ++i) {
+        int yy = (((y[i] - c.yOffset) << 6) * c.y) >> 16;
+        int uu = (u[i] - 128) << 6;
+        int vv = (v[i] - 128) << 6;
+        int r = yy + ((vv * c.rv) >> 16);
+        int g = yy - ((uu * c.gu) >> 16) - ((vv * c.gv) >> 16);
+        int b = yy + ((uu * c.bu) >> 16);
+        r = clampByte((r + 4) >> 3);
+        g = clampByte((g + 4) >> 3);
+        b = clampByte((b + 4) >> 3);
+        dst[i] = 0xff000000u | ((uint32_t)r << 16) | ((uint32_t)g << 8) | (uint32_t)b;
+    }
+}
+
+void lerpRowScalar(const uint8_t *a, const uint8_t *b, uint8_t *dst, int count, int weight)
+{
+    for (int i = 0; i < count; ++i) {
+        dst[i] = (uint8_t)(a[i] + (((b[i] - a[i]) * weight + YUV_WEIGHT_ONE / 2) >> YUV_WEIGHT_BITS));
+    }
+}
+
+// 10 位样本的垂直插值，同时截断为 8 位。
+// 按 SSE2 的 _mm_mulhi_epi16 方式计算：差值左移 5 位、权重左移 4 位，乘积取高 16 位
+void lerpRow10Scalar(const uint16_t *a, const uint16_t *b, uint8_t *dst, int count, int weight)
+{
+    for (int i = 0; i < count; ++i) {
+        int value = a[i] + ((((b[i] - a[i]) << 5) * (weight << 4)) >> 16);
+        dst[i] = (uint8_t)(value > 1023 ? 255 : value >> 2);
+    }
+}
+
+// 按插值表做水平插值：src 中相邻样本间隔为 Step（nv12 的交错色度为 2）
+template<int Step>
+void resampleRowStep(const uint8_t *src, uint8_t *dst, int count, const int32_t *index, const uint8_t *weight)
+{
+    for (int x = 0; x < count; ++x) {
+        const uint8_t *p = src + index[x] * Step;
+        dst[x] = (uint8_t)(p[0] + (((p[Step] - p[0]) * weight[x] + YUV_WEIGHT_ONE / 2) >> YUV_WEIGHT_BITS));
+    }
+}
+
+void resampleRow(const uint8_t *src, int step, uint8_t *dst, int count, const int32_t *index, const uint8_t *weight)
+{
+    if (step == 2) {
+        resampleRowStep<2>(src, dst, count, index, weight);
+    } else {
+        resampleRowStep<1>(src, dst, count, index, weight);
+    }
+}
+
+void resampleRowScalar(const uint8_t *src, int step, int srcCount, uint8_t *dst, int count,
+                       const int32_t *index, const uint8_t *weight)
+{
+    (void)srcCount;
+    resampleRow(src, step, dst, count, index, weight);
+}
+
+// 宽度不缩放时色度的 2 倍上采样，标量实现直接查插值表
+void upsampleRowScalar(const uint8_t *src, int step, int srcCount, uint8_t *dst, int count,
+                       const int32_t *index, const uint8_t *weight)
+{
+    (void)srcCount;
+    resampleRow(src, step, dst, count, index, weight);
+}
+
+#ifdef YUV_CONVERTER_X86
+
+// 8 个像素：输入为 16 位 Y/U/V，输出 8 个 RGB32
+__attribute__((target("sse2")))
+inline void convert8Sse2(__m128i y, __m128i u, __m128i v, uint32_t *dst, const YuvCoefficients &c)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i maxValue = _mm_set1_epi16(255);
+    const __m128i chromaOffset = _mm_set1_epi16(128);
+
+    y = _mm_slli_epi16(_mm_sub_epi16(y, _mm_set1_epi16(c.yOffset)), 6);
+    u = _mm_slli_epi16(_mm_sub_epi16(u, chromaOffset), 6);
+    v = _mm_slli_epi16(_mm_sub_epi16(v, chromaOffset), 6);
+
+    __m128i yy = _mm_mulhi_epi16(y, _mm_set1_epi16(c.y));
+    __m128i r = _mm_add_epi16(yy, _mm_mulhi_epi16(v, _mm_set1_epi16(c.rv)));
+    __m128i g = _mm_sub_epi16(_mm_sub_epi16(yy, _mm_mulhi_epi16(u, _mm_set1_epi16(c.gu))),
+                              _mm_mulhi_epi16(v, _mm_set1_epi16(c.gv)));
+    __m128i b = _mm_add_epi16(yy, _mm_mulhi_epi16(u, _mm_set1_epi16(c.bu)));
+
+    const __m128i round = _mm_set1_epi16(4);
+    r = _mm_min_epi16(_mm_max_epi16(_mm_srai_epi16(_mm_add_epi16(r, round), 3), zero), maxValue);
+    g = _mm_min_epi16(_mm_max_epi16(_mm_srai_epi16(_mm_add_epi16(g, round), 3), zero), maxValue);
+    b = _mm_min_epi16(_mm_max_epi16(_mm_srai_epi16(_mm_add_epi16(b, round), 3), zero), maxValue);
+
+    // 小端序下 RGB32 的字节顺序为 B G R A：先拼成 BG/RA 两个 16 位，再交错为 32 位
+    __m128i bg = _mm_or_si128(b, _mm_slli_epi16(g, 8));
+    __m128i ra = _mm_or_si128(r, _mm_set1_epi16((short)0xff00));
+    _mm_storeu_si128((__m128i*)dst, _mm_unpacklo_epi16(bg, ra));
+    _mm_storeu_si128((__m128i*)(dst + 4), _mm_unpackhi_epi16(bg, ra));
+}
+
+__attribute__((target("sse2")))
+void convertRowSse2(const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                    uint32_t *dst, int count, const YuvCoefficients &c)
+{
+    const __m128i zero = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i y8 = _mm_loadu_si128((const __m128i*)(y + i));
+        __m128i u8 = _mm_loadu_si128((const __m128i*)(u + i));
+        __m128i v8 = _mm_loadu_si128((const __m128i*)(v + i));
+        convert8Sse2(_mm_unpacklo_epi8(y8, zero), _mm_unpacklo_epi8(u8, zero), _mm_unpacklo_epi8(v8, zero),
+                     dst + i, c);
+        convert8Sse2(_mm_unpackhi_epi8(y8, zero), _mm_unpackhi_epi8(u8, zero), _mm_unpackhi_epi8(v8, zero),
+                     dst + i + 8, c);
+    }
+    convertRowScalar(y + i, u + i, v + i, dst + i, count - i, c);
+}
+
+__attribute__((target("sse2")))
+void lerpRowSse2(const uint8_t *a, const uint8_t *b, uint8_t *dst, int count, int weight)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i w = _mm_set1_epi16((short)weight);
+    const __m128i round = _mm_set1_epi16(YUV_WEIGHT_ONE / 2);
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i a8 = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i b8 = _mm_loadu_si128((const __m128i*)(b + i));
+        __m128i aLo = _mm_unpacklo_epi8(a8, zero);
+        __m128i aHi = _mm_unpackhi_epi8(a8, zero);
+        // 差值最大 ±255，乘以 7 位权重不会超出 16 位
+        __m128i dLo = _mm_mullo_epi16(_mm_sub_epi16(_mm_unpacklo_epi8(b8, zero), aLo), w);
+        __m128i dHi = _mm_mullo_epi16(_mm_sub_epi16(_mm_unpackhi_epi8(b8, zero), aHi), w);
+        __m128i lo = _mm_add_epi16(aLo, _mm_srai_epi16(_mm_add_epi16(dLo, round), YUV_WEIGHT_BITS));
+        __m128i hi = _mm_add_epi16(aHi, _mm_srai_epi16(_mm_add_epi16(dHi, round), YUV_WEIGHT_BITS));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(lo, hi));
+    }
+    lerpRowScalar(a + i, b + i, dst + i, count - i, weight);
+}
+
+__attribute__((target("sse2")))
+void lerpRow10Sse2(const uint16_t *a, const uint16_t *b, uint8_t *dst, int count, int weight)
+{
+    const __m128i w = _mm_set1_epi16((short)(weight << 4));
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m128i a0 = _mm_loadu_si128((const __m128i*)(a + i));
+        __m128i a1 = _mm_loadu_si128((const __m128i*)(a + i + 8));
+        __m128i b0 = _mm_loadu_si128((const __m128i*)(b + i));
+        __m128i b1 = _mm_loadu_si128((const __m128i*)(b + i + 8));
+        // 差值最大 ±1023，左移 5 位后仍在 16 位范围内
+        __m128i v0 = _mm_add_epi16(a0, _mm_mulhi_epi16(_mm_slli_epi16(_mm_sub_epi16(b0, a0), 5), w));
+        __m128i v1 = _mm_add_epi16(a1, _mm_mulhi_epi16(_mm_slli_epi16(_mm_sub_epi16(b1, a1), 5), w));
+        // 10 位截断为 8 位，packus 同时把越界值饱和到 255
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(_mm_srai_epi16(v0, 2), _mm_srai_epi16(v1, 2)));
+    }
+    lerpRow10Scalar(a + i, b + i, dst + i, count - i, weight);
+}
+
+// 从 src 取 16 个色度样本（step 为 2 时从交错数据中取偶数字节）
+__attribute__((target("sse2")))
+inline __m128i loadChroma16Sse2(const uint8_t *src, int step)
+{
+    if (step == 1) {
+        return _mm_loadu_si128((const __m128i*)src);
+    }
+    const __m128i mask = _mm_set1_epi16(0x00ff);
+    __m128i a = _mm_and_si128(_mm_loadu_si128((const __m128i*)src), mask);
+    __m128i b = _mm_and_si128(_mm_loadu_si128((const __m128i*)(src + 16)), mask);
+    return _mm_packus_epi16(a, b);
+}
+
+__attribute__((target("sse2")))
+void upsampleRowSse2(const uint8_t *src, int step, int srcCount, uint8_t *dst, int count,
+                     const int32_t *index, const uint8_t *weight)
+{
+    // 宽度不变时色度按左对齐位置 2 倍上采样：偶数列取原样本，奇数列取相邻两样本的平均，
+    // 与插值表权重 0 和 64 的结果逐位相同（_mm_avg_epu8 同样向上舍入）
+    // 每次读取 16 个样本及其右邻；交错数据按 32 字节整块读取，循环条件保证不越过行尾
+    int x = 0;
+    for (int k = 0; k + 16 + step <= srcCount && x + 32 <= count; k += 16, x += 32) {
+        __m128i current = loadChroma16Sse2(src + k * step, step);
+        __m128i next = loadChroma16Sse2(src + (k + 1) * step, step);
+        __m128i odd = _mm_avg_epu8(current, next);
+        _mm_storeu_si128((__m128i*)(dst + x), _mm_unpacklo_epi8(current, odd));
+        _mm_storeu_si128((__m128i*)(dst + x + 16), _mm_unpackhi_epi8(current, odd));
+    }
+    // 行尾最后一个色度样本没有右邻，按插值表处理
+    resampleRow(src, step, dst + x, count - x, index + x, weight + x);
+}
+
+__attribute__((target("avx2")))
+void resampleRowAvx2(const uint8_t *src, int step, int srcCount, uint8_t *dst, int count,
+                     const int32_t *index, const uint8_t *weight)
+{
+    // 每个输出一次取 4 字节，行尾的输出会越过最后一个样本；src 可能直接指向帧数据，
+    // 不依赖帧缓冲区的填充，取数会越界的尾部输出交给标量实现（插值表递增，从后往前找）
+    const int lastByte = (srcCount - 1) * step;
+    int simdCount = count;
+    while (simdCount > 0 && index[simdCount - 1] * step + 3 > lastByte) {
+        --simdCount;
+    }
+    const __m256i byteMask = _mm256_set1_epi32(0xff);
+    const __m256i round = _mm256_set1_epi32(YUV_WEIGHT_ONE / 2);
+    const __m128i nextShift = _mm_cvtsi32_si128(8 * step);
+    int x = 0;
+    for (; x + 8 <= simdCount; x += 8) {
+        __m256i offset = _mm256_loadu_si256((const __m256i*)(index + x));
+        if (step == 2) {
+            offset = _mm256_slli_epi32(offset, 1);
+        }
+        // 每个输出一次取 4 字节，低字节为当前样本，第 step 个字节为右邻样本
+        __m256i gathered = _mm256_i32gather_epi32((const int*)src, offset, 1);
+        __m256i p0 = _mm256_and_si256(gathered, byteMask);
+        __m256i p1 = _mm256_and_si256(_mm256_srl_epi32(gathered, nextShift), byteMask);
+        __m256i w = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(weight + x)));
+        __m256i delta = _mm256_mullo_epi32(_mm256_sub_epi32(p1, p0), w);
+        __m256i value = _mm256_add_epi32(p0, _mm256_srai_epi32(_mm256_add_epi32(delta, round), YUV_WEIGHT_BITS));
+        // 收窄为字节：packus 在通道内进行，两个通道各得到 4 个结果
+        __m256i packed = _mm256_packus_epi16(_mm256_packus_epi32(value, value), _mm256_setzero_si256());
+        int lo = _mm_cvtsi128_si32(_mm256_castsi256_si128(packed));
+        int hi = _mm_cvtsi128_si32(_mm256_extracti128_si256(packed, 1));
+        memcpy(dst + x, &lo, 4);
+        memcpy(dst + x + 4, &hi, 4);
+    }
+    resampleRow(src, step, dst + x, count - x, index + x, weight + x);
+}
+
+__attribute__((target("avx2")))
+void convertRowAvx2(const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                    uint32_t *dst, int count, const YuvCoefficients &c)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i maxValue = _mm256_set1_epi16(255);
+    const __m256i chromaOffset = _mm256_set1_epi16(128);
+    const __m256i yOffset = _mm256_set1_epi16(c.yOffset);
+    const __m256i cy = _mm256_set1_epi16(c.y);
+    const __m256i crv = _mm256_set1_epi16(c.rv);
+    const __m256i cgu = _mm256_set1_epi16(c.gu);
+    const __m256i cgv = _mm256_set1_epi16(c.gv);
+    const __m256i cbu = _mm256_set1_epi16(c.bu);
+    const __m256i round = _mm256_set1_epi16(4);
+    const __m256i alpha = _mm256_set1_epi16((short)0xff00);
+    int i = 0;
+    for (; i + 16 <= count; i += 16) {
+        __m256i y16 = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(y + i)));
+        __m256i u16 = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(u + i)));
+        __m256i v16 = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(v + i)));
+        y16 = _mm256_slli_epi16(_mm256_sub_epi16(y16, yOffset), 6);
+        u16 = _mm256_slli_epi16(_mm256_sub_epi16(u16, chromaOffset), 6);
+        v16 = _mm256_slli_epi16(_mm256_sub_epi16(v16, chromaOffset), 6);
+
+        __m256i yy = _mm256_mulhi_epi16(y16, cy);
+        __m256i r = _mm256_add_epi16(yy, _mm256_mulhi_epi16(v16, crv));
+        __m256i g = _mm256_sub_epi16(_mm256_sub_epi16(yy, _mm256_mulhi_epi16(u16, cgu)),
+                                     _mm256_mulhi_epi16(v16, cgv));
+        __m256i b = _mm256_add_epi16(yy, _mm256_mulhi_epi16(u16, cbu));
+
+        r = _mm256_min_epi16(_mm256_max_epi16(_mm256_srai_epi16(_mm256_add_epi16(r, round), 3), zero), maxValue);
+        g = _mm256_min_epi16(_mm256_max_epi16(_mm256_srai_epi16(_mm256_add_epi16(g, round), 3), zero), maxValue);
+        b = _mm256_min_epi16(_mm256_max_epi16(_mm256_srai_epi16(_mm256_add_epi16(b, round), 3), zero), maxValue);
+
+        __m256i bg = _mm256_or_si256(b, _mm256_slli_epi16(g, 8));
+        __m256i ra = _mm256_or_si256(r, alpha);
+        // unpack 在每个128位通道内交错：lo 为像素 0-3 和 8-11，hi 为像素 4-7 和 12-15，需要重新组合
+        __m256i lo = _mm256_unpacklo_epi16(bg, ra);
+        __m256i hi = _mm256_unpackhi_epi16(bg, ra);
+        _mm256_storeu_si256((__m256i*)(dst + i), _mm256_permute2x128_si256(lo, hi, 0x20));
+        _mm256_storeu_si256((__m256i*)(dst + i + 8), _mm256_permute2x128_si256(lo, hi, 0x31));
+    }
+    convertRowSse2(y + i, u + i, v + i, dst + i, count - i, c);
+}
+
+#endif // YUV_CONVERTER_X86
+
+#ifdef YUV_CONVERTER_NEON
+
+void convertRowNeon(const uint8_t *y, const uint8_t *u, const uint8_t *v,
+                    uint32_t *dst, int count, const YuvCoefficients &c)
+{
+    const int16x8_t yOffset = vdupq_n_s16(c.yOffset);
+    const int16x8_t chromaOffset = vdupq_n_s16(128);
+    int i = 0;
+    for (; i + 8 <= count; i += 8) {
+        // vqdmulhq 计算 (2*a*b)>>16，因此输入只左移 5 位，与 x86 的 (a<<6)*b>>16 结果相同
+        int16x8_t y16 = vshlq_n_s16(vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(y + i))), yOffset), 5);
+        int16x8_t u16 = vshlq_n_s16(vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(u + i))), chromaOffset), 5);
+        int16x8_t v16 = vshlq_n_s16(vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(v + i))), chromaOffset), 5);
+
+        int16x8_t yy = vqdmulhq_n_s16(y16, c.y);
+        int16x8_t r = vaddq_s16(yy, vqdmulhq_n_s16(v16, c.rv));
+        int16x8_t g = vsubq_s16(vsubq_s16(yy, vqdmulhq_n_s16(u16, c.gu)), vqdmulhq_n_s16(v16, c.gv));
+        int16x8_t b = vaddq_s16(yy, vqdmulhq_n_s16(u16, c.bu));
+
+        // 带舍入右移后饱和收窄到 [0, 255]，按 B G R A 交错写出
+        uint8x8x4_t pixels;
+        pixels.val[0] = vqmovun_s16(vrshrq_n_s16(b, 3));
+        pixels.val[1] = vqmovun_s16(vrshrq_n_s16(g, 3));
+        pixels.val[2] = vqmovun_s16(vrshrq_n_s16(r, 3));
+        pixels.val[3] = vdup_n_u8(0xff);
+        vst4_u8((uint8_t*)(dst + i), pixels);
+    }
+    convertRowScalar(y + i, u + i, v + i, dst + i, count - i, c);
+}
+
+#endif // YUV_CONVERTER_NEON
+
+YuvKernels selectKernels()
+{
+#ifdef YUV_CONVERTER_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return YuvKernels{convertRowAvx2, lerpRowSse2, lerpRow10Sse2, resampleRowAvx2, upsampleRowSse2, "avx2"};
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return YuvKernels{convertRowSse2, lerpRowSse2, lerpRow10Sse2, resampleRowScalar, upsampleRowSse2, "sse2"};
+    }
+#endif
+#ifdef YUV_CONVERTER_NEON
+    return YuvKernels{convertRowNeon, lerpRowScalar, lerpRow10Scalar, resampleRowScalar, upsampleRowScalar, "neon"};
+#endif
+    return YuvKernels{convertRowScalar, lerpRowScalar, lerpRow10Scalar, resampleRowScalar, upsampleRowScalar, "scalar"};
+}
+
+YuvKernels &kernels()
+{
+    static YuvKernels selected = selectKernels();
+    return selected;
+}
+
+// 源坐标：按像素中心对齐，pos 为浮点源坐标
+void splitPosition(double pos, int limit, int &index, int &weight)
+{
+    if (pos < 0.0) {
+        pos = 0.0;
+    }
+    index = (int)pos;
+    weight = (int)lrint((pos - index) * YUV_WEIGHT_ONE);
+    if (weight == YUV_WEIGHT_ONE) {
+        ++index;
+        weight = 0;
+    }
+    // 保证 index + 1 不越界：最后一个样本用前一个样本加满权重表示
+    if (index >= limit - 1) {
+        index = limit > 1 ? limit - 2 : 0;
+        weight = limit > 1 ? YUV_WEIGHT_ONE : 0;
+    }
+}
+
+// 取得一个平面在 pos 处垂直插值后的行（8 位样本数为 samples）
+const uint8_t *verticalRow(const AVFrame *frame, int plane, double pos, int rows, int samples,
+                           bool tenBit, std::vector<uint8_t> &scratch)
+{
+    int row = 0;
+    int weight = 0;
+    splitPosition(pos, rows, row, weight);
+    int nextRow = rows > 1 ? row + 1 : row;
+    const uint8_t *a = frame->data[plane] + (ptrdiff_t)row * frame->linesize[plane];
+    const uint8_t *b = frame->data[plane] + (ptrdiff_t)nextRow * frame->linesize[plane];
+
+    if (tenBit) {
+        kernels().lerpRow10((const uint16_t*)a, (const uint16_t*)b, scratch.data(), samples, weight);
+        return scratch.data();
+    }
+    if (weight == 0) {
+        // 正好落在源行上（包括不缩放的情况），直接使用源数据
+        return a;
+    }
+    if (weight == YUV_WEIGHT_ONE) {
+        return b;
+    }
+    kernels().lerpRow(a, b, scratch.data(), samples, weight);
+    return scratch.data();
+}
+
+} // namespace
+
+YuvConverter::YuvConverter()
+    : m_srcWidth(0)
+    , m_srcHeight(0)
+    , m_dstWidth(0)
+    , m_dstHeight(0)
+{
+
+}
+
+bool YuvConverter::isSupported(int format)
+{
+    switch (format) {
+    case AV_PIX_FMT_YUV420P:
+    case AV_PIX_FMT_YUVJ420P:
+    case AV_PIX_FMT_NV12:
+    case AV_PIX_FMT_YUV420P10LE:
+        return true;
+    default:
+        return false;
+    }
+}
+
+const char *YuvConverter::kernelName()
+{
+    return kernels().name;
+}
+
+bool YuvConverter::setKernel(const char *name)
+{
+    if (strcmp(name, "scalar") == 0) {
+        kernels() = YuvKernels{convertRowScalar, lerpRowScalar, lerpRow10Scalar, resampleRowScalar, upsampleRowScalar, "scalar"};
+        return true;
+    }
+#ifdef YUV_CONVERTER_X86
+    __builtin_cpu_init();
+    if (strcmp(name, "sse2") == 0 && __builtin_cpu_supports("sse2")) {
+        kernels() = YuvKernels{convertRowSse2, lerpRowSse2, lerpRow10Sse2, resampleRowScalar, upsampleRowSse2, "sse2"};
+        return true;
+    }
+    if (strcmp(name, "avx2") == 0 && __builtin_cpu_supports("avx2")) {
+        kernels() = YuvKernels{convertRowAvx2, lerpRowSse2, lerpRow10Sse2, resampleRowAvx2, upsampleRowSse2, "avx2"};
+        return true;
+    }
+#endif
+#ifdef YUV_CONVERTER_NEON
+    if (strcmp(name, "neon") == 0) {
+        kernels() = YuvKernels{convertRowNeon, lerpRowScalar, lerpRow10Scalar, resampleRowScalar, upsampleRowScalar, "neon"};
+        return true;
+    }
+#endif
+    return false;
+}
+
+void YuvConverter::buildTable(AxisTable &table, int srcSize, int dstSize, int srcLimit, bool chroma)
+{
+    table.index.resize(dstSize);
+    table.weight.resize(dstSize);
+    double scale = (double)srcSize / dstSize;
+    for (int i = 0; i < dstSize; ++i) {
+        double pos = (i + 0.5) * scale - 0.5;
+        if (chroma) {
+            // 4:2:0 色度水平方向与偶数列亮度对齐（MPEG-2/H.264 默认位置）
+            pos /= 2.0;
+        }
+        int index = 0;
+        int weight = 0;
+        splitPosition(pos, srcLimit, index, weight);
+        table.index[i] = index;
+        table.weight[i] = (uint8_t)weight;
+    }
+}
+
+void YuvConverter::prepare(int srcWidth, int srcHeight, int dstWidth, int dstHeight)
+{
+    if (srcWidth == m_srcWidth && srcHeight == m_srcHeight
+        && dstWidth == m_dstWidth && dstHeight == m_dstHeight) {
+        return;
+    }
+    m_srcWidth = srcWidth;
+    m_srcHeight = srcHeight;
+    m_dstWidth = dstWidth;
+    m_dstHeight = dstHeight;
+
+    int chromaWidth = (srcWidth + 1) / 2;
+    buildTable(m_lumaX, srcWidth, dstWidth, srcWidth, false);
+    buildTable(m_chromaX, srcWidth, dstWidth, chromaWidth, true);
+
+    // nv12 的交错色度行是色度宽度的两倍
+    m_rowY.resize(srcWidth + YUV_ROW_PADDING);
+    m_rowU.resize(chromaWidth * 2 + YUV_ROW_PADDING);
+    m_rowV.resize(chromaWidth + YUV_ROW_PADDING);
+    m_lineY.resize(dstWidth + YUV_ROW_PADDING);
+    m_lineU.resize(dstWidth + YUV_ROW_PADDING);
+    m_lineV.resize(dstWidth + YUV_ROW_PADDING);
+}
+
+bool YuvConverter::convert(const AVFrame *frame, uint8_t *dst, int dstStride, int dstWidth, int dstHeight)
+{
+    if (!isSupported(frame->format) || frame->width <= 0 || frame->height <= 0
+        || dstWidth <= 0 || dstHeight <= 0) {
+        return false;
+    }
+    int srcWidth = frame->width;
+    int srcHeight = frame->height;
+    int chromaWidth = (srcWidth + 1) / 2;
+    int chromaHeight = (srcHeight + 1) / 2;
+    bool nv12 = frame->format == AV_PIX_FMT_NV12;
+    bool tenBit = frame->format == AV_PIX_FMT_YUV420P10LE;
+
+    prepare(srcWidth, srcHeight, dstWidth, dstHeight);
+    const YuvCoefficients &coefficients = selectCoefficients(frame);
+    const YuvKernels &k = kernels();
+    double scaleY = (double)srcHeight / dstHeight;
+    bool sameWidth = srcWidth == dstWidth;
+
+    for (int row = 0; row < dstHeight; ++row) {
+        // 垂直方向：亮度按像素中心映射，4:2:0 色度位于两行亮度中间
+        double lumaPos = (row + 0.5) * scaleY - 0.5;
+        double chromaPos = (lumaPos + 0.5) / 2.0 - 0.5;
+
+        const uint8_t *y = verticalRow(frame, 0, lumaPos, srcHeight, srcWidth, tenBit, m_rowY);
+        const uint8_t *u;
+        const uint8_t *v;
+        int chromaStep = 1;
+        if (nv12) {
+            u = verticalRow(frame, 1, chromaPos, chromaHeight, chromaWidth * 2, false, m_rowU);
+            v = u + 1;
+            chromaStep = 2;
+        } else {
+            u = verticalRow(frame, 1, chromaPos, chromaHeight, chromaWidth, tenBit, m_rowU);
+            v = verticalRow(frame, 2, chromaPos, chromaHeight, chromaWidth, tenBit, m_rowV);
+        }
+
+        // 水平方向：宽度不变时亮度直接使用、色度走 2 倍上采样内核，否则按插值表缩小
+        if (sameWidth) {
+            k.upsampleRow(u, chromaStep, chromaWidth, m_lineU.data(), dstWidth,
+                          m_chromaX.index.data(), m_chromaX.weight.data());
+            k.upsampleRow(v, chromaStep, chromaWidth, m_lineV.data(), dstWidth,
+                          m_chromaX.index.data(), m_chromaX.weight.data());
+        } else {
+            k.resampleRow(y, 1, srcWidth, m_lineY.data(), dstWidth, m_lumaX.index.data(), m_lumaX.weight.data());
+            y = m_lineY.data();
+            k.resampleRow(u, chromaStep, chromaWidth, m_lineU.data(), dstWidth,
+                          m_chromaX.index.data(), m_chromaX.weight.data());
+            k.resampleRow(v, chromaStep, chromaWidth, m_lineV.data(), dstWidth,
+                          m_chromaX.index.data(), m_chromaX.weight.data());
+        }
+
+        uint32_t *out = (uint32_t*)(dst + (ptrdiff_t)row * dstStride);
+        k.convertRow(y, m_lineU.data(), m_lineV.data(), out, dstWidth, coefficients);
+    }
+    return true;
+}
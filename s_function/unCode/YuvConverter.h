@@ -0,0 +1,92 @@
+#ifndef YUVCONVERTER_H
+#define YUVCONVERTER_H
+
+#include <cstdint>
+#include <vector>
+
+extern "C" {
+#include <libavutil/frame.h>
+}
+
+/**
+ * @brief 常见解码输出格式到 32 位 RGB 的转换（带双线性缩小）
+ *
+ * 支持 yuv420p/yuvj420p、nv12、yuv420p10le，输出 QImage::Format_RGB32
+ * （alpha 固定为 0xff，同时也是合法的 ARGB32_Premultiplied），
+ * 纹理上传和 QPainter 都不需要再从 3 字节格式展开。
+ *
+ * 按输出行处理：先在源图像上做垂直插值得到一行 Y/U/V，再做水平插值到输出宽度，
+ * 最后转换为 RGB32 写入目标行。缩放与颜色转换在同一遍内完成，不产生整帧中间图像。
+ * 颜色矩阵按帧的 colorspace/color_range 选择 BT.601 或 BT.709、有限或全范围。
+ *
+ * 行转换内核在第一次使用时按 CPU 能力选择：AVX2 > SSE2 > 标量，
+ * ARM 平台编译时启用 NEON 则使用 NEON 实现。
+ * 其他像素格式由调用者回退到 swscale。
+ *
+ * 已知取舍：缩小只做双线性插值，每个输出像素只取相邻的 2x2 个源像素。缩小超过 2 倍时
+ * （如 4K → 720p 为 3 倍）部分源像素不参与计算，细密纹理和文字边缘会出现混叠，
+ * 画质不如之前 swscale 的 SWS_BICUBIC 路径。
+ *
+ * 注意事项：
+ * - 内部保存行缓冲和插值表，同一对象只能由一个线程使用
+ */
+class YuvConverter
+{
+public:
+    YuvConverter();
+
+    /**
+     * @brief 是否支持该像素格式（AVPixelFormat）
+     */
+    static bool isSupported(int format);
+
+    /**
+     * @brief 转换一帧
+     * @param dst 目标像素内存，每像素 4 字节
+     * @param dstStride 目标每行字节数
+     * @param dstWidth/dstHeight 目标尺寸，不大于源尺寸时为双线性缩小
+     * @return false 像素格式不支持
+     */
+    bool convert(const AVFrame *frame, uint8_t *dst, int dstStride, int dstWidth, int dstHeight);
+
+    /**
+     * @brief 当前使用的行转换内核名称（"avx2"、"sse2"、"neon" 或 "scalar"）
+     */
+    static const char *kernelName();
+
+    /**
+     * @brief 强制使用指定内核（"avx2"、"sse2"、"neon" 或 "scalar"），供基准测试对比各实现
+     * @return false CPU 或编译器不支持该内核，仍使用原来的内核
+     * @note 不能与转换同时调用
+     */
+    static bool setKernel(const char *name);
+
+private:
+    // 水平插值表：每个输出像素对应的源样本下标和 7 位小数权重
+    struct AxisTable {
+        std::vector<int32_t> index;
+        std::vector<uint8_t> weight;
+    };
+
+    // 源/目标尺寸变化时重建插值表
+    void prepare(int srcWidth, int srcHeight, int dstWidth, int dstHeight);
+    static void buildTable(AxisTable &table, int srcSize, int dstSize, int srcLimit, bool chroma);
+
+    int m_srcWidth;
+    int m_srcHeight;
+    int m_dstWidth;
+    int m_dstHeight;
+
+    AxisTable m_lumaX;
+    AxisTable m_chromaX;
+
+    // 垂直插值后的源宽度行，以及水平插值后的输出宽度行
+    std::vector<uint8_t> m_rowY;
+    std::vector<uint8_t> m_rowU;
+    std::vector<uint8_t> m_rowV;
+    std::vector<uint8_t> m_lineY;
+    std::vector<uint8_t> m_lineU;
+    std::vector<uint8_t> m_lineV;
+};
+
+#endif // YUVCONVERTER_H
@@ -1,9 +1,23 @@
 HEADERS += \
     $$PWD/AudioCode.h \
-    $$PWD/VideoCode.h
+    $$PWD/Demuxer.h \
+    $$PWD/FramePool.h \
+    $$PWD/KeyframeIndex.h \
+    $$PWD/KeyframeScanner.h \
+    $$PWD/PacketQueue.h \
+    $$PWD/VideoCode.h \
+    $$PWD/VideoConverter.h \
+    $$PWD/YuvConverter.h
 
 SOURCES += \
     $$PWD/AudioCode.cpp \
-    $$PWD/VideoCode.cpp
+    $$PWD/Demuxer.cpp \
+    $$PWD/FramePool.cpp \
+    $$PWD/KeyframeIndex.cpp \
+    $$PWD/KeyframeScanner.cpp \
+    $$PWD/PacketQueue.cpp \
+    $$PWD/VideoCode.cpp \
+    $$PWD/VideoConverter.cpp \
+    $$PWD/YuvConverter.cpp
 
 DISTFILES +=
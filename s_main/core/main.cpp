@@ -29,25 +29,24 @@ int main(int argc, char *argv[])
     AudioOutput::getInstance()->initialize();
     EkhoTTS::getInstance()->initialize();
 
-    // 在主线程中获取队列索引（使用主线程ID）
-    // qintptr mainThreadId = reinterpret_cast<qintptr>(QThread::currentThreadId());
-    // int queueIndex = AudioOutput::getInstance()->addThreadIdToPlayQueue(mainThreadId);
+    // 在主线程中打开一路音频
+    // std::shared_ptr<AudioStream> audioStream = AudioOutput::getInstance()->openStream();
     
     // EkhoTTS::getInstance()->addTextToQueue("你好，我是小爱同学，很高兴认识你，今天天气不错，是个好天气，你好，我是小爱同学，很高兴认识你，今天天气不错，是个好天气，你好，我是小爱同学，很高兴认识你，今天天气不错，是个好天气，你好，我是小爱同学，很高兴认识你，今天天气不错，是个好天气，你好，我是小爱同学，很高兴认识你，今天天气不错，是个好天气");
 
-    // if (queueIndex >= 0) {
+    // if (audioStream) {
     //     // 使用 ekho 可执行文件生成语音，直接从标准输出读取 PCM 数据
     //     QString text = "你好，我是小爱同学，很高兴认识你";
     //     QByteArray audioData = EkhoTTS::getInstance()->synthesize(text);
     //     if (!audioData.isEmpty()) {
     //         qDebug() << "成功从标准输出读取 PCM 数据，大小:" << audioData.size() << "字节";
     //         // 添加音频数据到队列
-    //         AudioOutput::getInstance()->addAudioDataToQueue(queueIndex, audioData);
+    //         audioStream->write(audioData);
     //     } else {
     //         qDebug() << "标准输出数据为空";
     //     }
     // } else {
-    //     qDebug() << "无法获取音频队列索引";
+    //     qDebug() << "无法打开音频流";
     // }
 
     VideoFunction videoFunction;